@@ -0,0 +1,58 @@
+-- ULID generation benchmark
+-- Compares per-row pg_strong_random() calls against the buffered entropy pool
+-- and the ChaCha20 source on the 06_scale.sql workload (1 million rows, two
+-- ULIDs per row).
+
+\set ECHO all
+\timing on
+SET client_min_messages = warning;
+CREATE EXTENSION IF NOT EXISTS pg_ulid;
+
+CREATE TEMPORARY TABLE ulids_bench (
+   ulid_test1 ulid PRIMARY KEY,
+   ulid_test2 ulid
+);
+
+-- Generation only: one pg_strong_random() call per ULID
+SET ulid.entropy_pool_size = 0;
+SELECT COUNT(gen_random_ulid()) FROM generate_series(1, 1000000);
+
+-- Generation only: default entropy pool
+RESET ulid.entropy_pool_size;
+SELECT COUNT(gen_random_ulid()) FROM generate_series(1, 1000000);
+
+-- Generation only: largest entropy pool
+SET ulid.entropy_pool_size = '64kB';
+SELECT COUNT(gen_random_ulid()) FROM generate_series(1, 1000000);
+
+-- Generation only: ChaCha20 source, with and without the pool
+SET ulid.random_source = 'chacha';
+SELECT COUNT(gen_random_ulid()) FROM generate_series(1, 1000000);
+SET ulid.entropy_pool_size = 0;
+SELECT COUNT(gen_random_ulid()) FROM generate_series(1, 1000000);
+RESET ulid.entropy_pool_size;
+RESET ulid.random_source;
+
+-- Generation only: batch generator (one clock read, one random draw)
+RESET ulid.entropy_pool_size;
+SELECT COUNT(*) FROM gen_random_ulids(1000000);
+SELECT cardinality(gen_random_ulid_array(1000000));
+
+-- INSERT ... SELECT: one pg_strong_random() call per ULID
+SET ulid.entropy_pool_size = 0;
+INSERT INTO ulids_bench (ulid_test1, ulid_test2)
+SELECT gen_random_ulid(), gen_random_ulid() FROM generate_series(1, 1000000);
+TRUNCATE ulids_bench;
+
+-- INSERT ... SELECT: default entropy pool
+RESET ulid.entropy_pool_size;
+INSERT INTO ulids_bench (ulid_test1, ulid_test2)
+SELECT gen_random_ulid(), gen_random_ulid() FROM generate_series(1, 1000000);
+TRUNCATE ulids_bench;
+
+-- INSERT ... SELECT: batch generator
+INSERT INTO ulids_bench (ulid_test1)
+SELECT id FROM gen_random_ulids(1000000) AS id;
+TRUNCATE ulids_bench;
+
+DROP TABLE ulids_bench;
@@ -0,0 +1,23 @@
+-- ULID clock source benchmark
+-- Compares the per-row cost of CLOCK_REALTIME and CLOCK_REALTIME_COARSE.
+-- The entropy pool keeps random byte costs out of the comparison.
+
+\set ECHO all
+\timing on
+SET client_min_messages = warning;
+CREATE EXTENSION IF NOT EXISTS pg_ulid;
+
+-- Baseline: the same row count without any ULID generation
+SELECT COUNT(*) FROM generate_series(1, 1000000);
+
+-- CLOCK_REALTIME (default)
+SET ulid.clock_source = 'realtime';
+SELECT COUNT(gen_random_ulid()) FROM generate_series(1, 1000000);
+SELECT COUNT(gen_monotonic_ulid()) FROM generate_series(1, 1000000);
+
+-- CLOCK_REALTIME_COARSE
+SET ulid.clock_source = 'realtime_coarse';
+SELECT COUNT(gen_random_ulid()) FROM generate_series(1, 1000000);
+SELECT COUNT(gen_monotonic_ulid()) FROM generate_series(1, 1000000);
+
+RESET ulid.clock_source;
@@ -0,0 +1,31 @@
+-- ULID array conversion benchmark
+-- Compares array_out() and per-element coercion against the whole-array
+-- conversions on 1,000 arrays of 1,000 ULIDs (1 million values).
+
+\set ECHO all
+\timing on
+SET client_min_messages = warning;
+CREATE EXTENSION IF NOT EXISTS pg_ulid;
+
+CREATE TEMPORARY TABLE ulid_arrays AS
+SELECT gen_random_ulid_array(1000) AS a FROM generate_series(1, 1000);
+CREATE TEMPORARY TABLE text_arrays AS
+SELECT ulid_array_to_text(a) AS t FROM ulid_arrays;
+
+-- Text output: array_out() calling ulid_out() per element
+SELECT SUM(length(format('%s', a))) FROM ulid_arrays;
+
+-- Text output: ulid_array_out()
+SELECT SUM(length(a::text)) FROM ulid_arrays;
+
+-- ulid[] -> text[]: per-element cast
+SELECT SUM(cardinality(ARRAY(SELECT u::text FROM unnest(a) AS u))) FROM ulid_arrays;
+
+-- ulid[] -> text[]: ulid_array_to_text()
+SELECT SUM(cardinality(a::text[])) FROM ulid_arrays;
+
+-- text[] -> ulid[]: per-element cast
+SELECT SUM(cardinality(ARRAY(SELECT v::ulid FROM unnest(t) AS v))) FROM text_arrays;
+
+-- text[] -> ulid[]: ulid_array_from_text()
+SELECT SUM(cardinality(t::ulid[])) FROM text_arrays;
@@ -0,0 +1,45 @@
+-- ULID COPY throughput benchmark
+-- Compares text and binary COPY of a ULID column (ulid_out/ulid_in against
+-- ulid_send/ulid_recv), with uuid and bytea columns of the same 16 bytes as
+-- a baseline (1 million values). pg_dump writes table data with text COPY,
+-- so the text timings also stand for dump and restore.
+-- COPY to and from a server file requires superuser or the
+-- pg_write_server_files / pg_read_server_files roles.
+
+\set ECHO all
+\timing on
+SET client_min_messages = warning;
+CREATE EXTENSION IF NOT EXISTS pg_ulid;
+
+CREATE TEMPORARY TABLE ulids_src AS
+SELECT gen_random_ulid() AS id FROM generate_series(1, 1000000);
+CREATE TEMPORARY TABLE uuids_src AS SELECT id::uuid AS id FROM ulids_src;
+CREATE TEMPORARY TABLE byteas_src AS SELECT id::bytea AS id FROM ulids_src;
+CREATE TEMPORARY TABLE ulids_dest (id ulid);
+CREATE TEMPORARY TABLE uuids_dest (id uuid);
+CREATE TEMPORARY TABLE byteas_dest (id bytea);
+
+-- COPY TO: ulid, text and binary
+COPY ulids_src TO '/tmp/pg_ulid_bench_copy.txt';
+COPY ulids_src TO '/tmp/pg_ulid_bench_copy.bin' WITH (FORMAT binary);
+
+-- COPY FROM: ulid, text and binary
+COPY ulids_dest FROM '/tmp/pg_ulid_bench_copy.txt';
+TRUNCATE ulids_dest;
+COPY ulids_dest FROM '/tmp/pg_ulid_bench_copy.bin' WITH (FORMAT binary);
+
+-- COPY TO / FROM: uuid, text and binary
+COPY uuids_src TO '/tmp/pg_ulid_bench_copy.txt';
+COPY uuids_src TO '/tmp/pg_ulid_bench_copy.bin' WITH (FORMAT binary);
+COPY uuids_dest FROM '/tmp/pg_ulid_bench_copy.txt';
+TRUNCATE uuids_dest;
+COPY uuids_dest FROM '/tmp/pg_ulid_bench_copy.bin' WITH (FORMAT binary);
+
+-- COPY TO / FROM: bytea, binary only
+COPY byteas_src TO '/tmp/pg_ulid_bench_copy.bin' WITH (FORMAT binary);
+COPY byteas_dest FROM '/tmp/pg_ulid_bench_copy.bin' WITH (FORMAT binary);
+
+-- Send only: ulid_send() without the COPY machinery
+SELECT COUNT(ulid_send(id)) FROM ulids_src;
+
+\! rm -f /tmp/pg_ulid_bench_copy.txt /tmp/pg_ulid_bench_copy.bin
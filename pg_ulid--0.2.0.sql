@@ -0,0 +1,336 @@
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION pg_ulid" to load this file. \quit
+
+CREATE TYPE ulid;
+CREATE FUNCTION ulid_in (cstring)
+    RETURNS ulid
+    AS 'MODULE_PATHNAME', 'ulid_in'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_out (ulid)
+    RETURNS cstring AS 'MODULE_PATHNAME', 'ulid_out'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_recv (internal)
+    RETURNS ulid AS 'MODULE_PATHNAME', 'ulid_recv'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_send (ulid)
+    RETURNS bytea AS 'MODULE_PATHNAME', 'ulid_send'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+-- Collects timestamp statistics on top of the standard ones
+CREATE FUNCTION ulid_typanalyze(internal)
+    RETURNS bool AS 'MODULE_PATHNAME', 'ulid_typanalyze'
+    LANGUAGE C STRICT PARALLEL SAFE;
+CREATE TYPE ulid (
+    INPUT = ulid_in,
+    OUTPUT = ulid_out,
+    RECEIVE = ulid_recv,
+    SEND = ulid_send,
+    INTERNALLENGTH = 16,
+    ALIGNMENT = double,
+    STORAGE = plain,
+    ANALYZE = ulid_typanalyze
+);
+CREATE FUNCTION ulid_to_text(ulid)
+    RETURNS text AS 'MODULE_PATHNAME', 'ulid_to_text'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_from_text(text)
+    RETURNS ulid AS 'MODULE_PATHNAME', 'ulid_from_text'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- Direct text conversions, replacing I/O conversion casts in the same contexts
+CREATE CAST (ulid AS text) WITH FUNCTION ulid_to_text(ulid) AS ASSIGNMENT;
+CREATE CAST (ulid AS varchar) WITH FUNCTION ulid_to_text(ulid) AS ASSIGNMENT;
+CREATE CAST (text AS ulid) WITH FUNCTION ulid_from_text(text);
+CREATE CAST (varchar AS ulid) WITH FUNCTION ulid_from_text(text);
+
+CREATE FUNCTION ulid_to_uuid(ulid)
+    RETURNS uuid AS 'MODULE_PATHNAME', 'ulid_to_uuid'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_from_uuid(uuid)
+    RETURNS ulid AS 'MODULE_PATHNAME', 'ulid_from_uuid'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_to_bytea(ulid)
+    RETURNS bytea AS 'MODULE_PATHNAME', 'ulid_to_bytea'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_from_bytea(bytea)
+    RETURNS ulid AS 'MODULE_PATHNAME', 'ulid_from_bytea'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- Byte-for-byte conversions; ulid is double-aligned and uuid is not, so the
+-- uuid casts cannot be WITHOUT FUNCTION
+CREATE CAST (ulid AS uuid) WITH FUNCTION ulid_to_uuid(ulid) AS ASSIGNMENT;
+CREATE CAST (uuid AS ulid) WITH FUNCTION ulid_from_uuid(uuid) AS ASSIGNMENT;
+CREATE CAST (ulid AS bytea) WITH FUNCTION ulid_to_bytea(ulid);
+CREATE CAST (bytea AS ulid) WITH FUNCTION ulid_from_bytea(bytea);
+
+CREATE FUNCTION ulid_array_to_text(ulid[])
+    RETURNS text[] AS 'MODULE_PATHNAME', 'ulid_array_to_text'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_array_from_text(text[])
+    RETURNS ulid[] AS 'MODULE_PATHNAME', 'ulid_array_from_text'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_array_out(ulid[])
+    RETURNS text AS 'MODULE_PATHNAME', 'ulid_array_out'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- Whole-array conversions, replacing per-element coercion in the same contexts
+CREATE CAST (ulid[] AS text[]) WITH FUNCTION ulid_array_to_text(ulid[]) AS ASSIGNMENT;
+CREATE CAST (text[] AS ulid[]) WITH FUNCTION ulid_array_from_text(text[]);
+CREATE CAST (ulid[] AS text) WITH FUNCTION ulid_array_out(ulid[]) AS ASSIGNMENT;
+
+CREATE FUNCTION jsonb_ulid(doc jsonb, key text)
+    RETURNS ulid AS 'MODULE_PATHNAME', 'jsonb_ulid'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_from_jsonb(jsonb)
+    RETURNS ulid AS 'MODULE_PATHNAME', 'ulid_from_jsonb'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_to_jsonb(ulid)
+    RETURNS jsonb AS 'MODULE_PATHNAME', 'ulid_to_jsonb'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- jsonb strings are decoded in place, without building an intermediate text
+CREATE CAST (jsonb AS ulid) WITH FUNCTION ulid_from_jsonb(jsonb);
+CREATE CAST (ulid AS jsonb) WITH FUNCTION ulid_to_jsonb(ulid);
+
+CREATE FUNCTION ulid_to_uuidv7(ulid)
+    RETURNS uuid AS 'MODULE_PATHNAME', 'ulid_to_uuidv7'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION uuidv7_to_ulid(uuid)
+    RETURNS ulid AS 'MODULE_PATHNAME', 'uuidv7_to_ulid'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION gen_random_ulid()
+    RETURNS ulid AS 'MODULE_PATHNAME', 'gen_random_ulid'
+    LANGUAGE C VOLATILE STRICT PARALLEL SAFE;
+CREATE FUNCTION gen_random_ulid_v7compat()
+    RETURNS ulid AS 'MODULE_PATHNAME', 'gen_random_ulid_v7compat'
+    LANGUAGE C VOLATILE STRICT PARALLEL SAFE;
+CREATE FUNCTION gen_monotonic_ulid()
+    RETURNS ulid AS 'MODULE_PATHNAME', 'gen_monotonic_ulid'
+    LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+CREATE FUNCTION gen_statement_ulid()
+    RETURNS ulid AS 'MODULE_PATHNAME', 'gen_statement_ulid'
+    LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+CREATE FUNCTION gen_ulid_at(ts timestamptz)
+    RETURNS ulid AS 'MODULE_PATHNAME', 'gen_ulid_at'
+    LANGUAGE C VOLATILE STRICT PARALLEL SAFE;
+CREATE FUNCTION gen_monotonic_ulid_at(ts timestamptz)
+    RETURNS ulid AS 'MODULE_PATHNAME', 'gen_monotonic_ulid_at'
+    LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+CREATE FUNCTION gen_random_ulids(count int4)
+    RETURNS SETOF ulid AS 'MODULE_PATHNAME', 'gen_random_ulids'
+    LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+CREATE FUNCTION gen_random_ulid_array(count int4)
+    RETURNS ulid[] AS 'MODULE_PATHNAME', 'gen_random_ulid_array'
+    LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+CREATE FUNCTION gen_shared_ulid()
+    RETURNS ulid AS 'MODULE_PATHNAME', 'gen_shared_ulid'
+    LANGUAGE C VOLATILE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_shared_retries()
+    RETURNS int8 AS 'MODULE_PATHNAME', 'ulid_shared_retries'
+    LANGUAGE C VOLATILE STRICT PARALLEL SAFE;
+CREATE FUNCTION gen_node_ulid()
+    RETURNS ulid AS 'MODULE_PATHNAME', 'gen_node_ulid'
+    LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+CREATE FUNCTION ulid_node_id(ulid, node_bits int4)
+    RETURNS int4 AS 'MODULE_PATHNAME', 'ulid_node_id_bits'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_node_id(ulid)
+    RETURNS int4 AS 'MODULE_PATHNAME', 'ulid_node_id_current'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_timestamp(ulid)
+    RETURNS timestamptz AS 'MODULE_PATHNAME', 'ulid_timestamp'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_min_at(ts timestamptz)
+    RETURNS ulid AS 'MODULE_PATHNAME', 'ulid_min_at'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_max_at(ts timestamptz)
+    RETURNS ulid AS 'MODULE_PATHNAME', 'ulid_max_at'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_time_support(internal)
+    RETURNS internal AS 'MODULE_PATHNAME', 'ulid_time_support'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- The support function turns calls on an indexed ulid column into btree
+-- range conditions on the ULID itself
+CREATE FUNCTION ulid_time_between(id ulid, start_ts timestamptz, end_ts timestamptz)
+    RETURNS bool AS 'MODULE_PATHNAME', 'ulid_time_between'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+    SUPPORT ulid_time_support;
+
+CREATE FUNCTION ulid_cmp(ulid, ulid)
+    RETURNS int4
+    AS 'MODULE_PATHNAME', 'ulid_cmp'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_eq(ulid, ulid)
+    RETURNS bool
+    AS 'MODULE_PATHNAME', 'ulid_eq'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_ne(ulid, ulid)
+    RETURNS bool AS 'MODULE_PATHNAME', 'ulid_ne'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_ge(ulid, ulid)
+    RETURNS bool AS 'MODULE_PATHNAME', 'ulid_ge'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_gt(ulid, ulid)
+    RETURNS bool AS 'MODULE_PATHNAME', 'ulid_gt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_le(ulid, ulid)
+    RETURNS bool AS 'MODULE_PATHNAME', 'ulid_le'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_lt(ulid, ulid)
+    RETURNS bool AS 'MODULE_PATHNAME', 'ulid_lt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- Restriction estimators for the inequality operators; they read the
+-- column histogram as ULIDs and understand timestamptz bounds
+CREATE FUNCTION ulid_ltsel(internal, oid, internal, int4)
+    RETURNS float8 AS 'MODULE_PATHNAME', 'ulid_ltsel'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_lesel(internal, oid, internal, int4)
+    RETURNS float8 AS 'MODULE_PATHNAME', 'ulid_lesel'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_gtsel(internal, oid, internal, int4)
+    RETURNS float8 AS 'MODULE_PATHNAME', 'ulid_gtsel'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_gesel(internal, oid, internal, int4)
+    RETURNS float8 AS 'MODULE_PATHNAME', 'ulid_gesel'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION ulid_sortsupport(internal)
+    RETURNS VOID AS 'MODULE_PATHNAME', 'ulid_sortsupport'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION ulid_hash(ulid)
+    RETURNS int AS 'MODULE_PATHNAME', 'ulid_hash'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION ulid_hash_extended(ulid, bigint)
+    RETURNS bigint AS 'MODULE_PATHNAME', 'ulid_hash_extended'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR <> ( PROCEDURE = ulid_ne,
+	LEFTARG = ulid, RIGHTARG = ulid,
+	NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel);
+CREATE OPERATOR > ( PROCEDURE = ulid_gt,
+	LEFTARG = ulid, RIGHTARG = ulid,
+	COMMUTATOR = <, NEGATOR = <=,
+	RESTRICT = ulid_gtsel, JOIN = scalargtjoinsel);
+CREATE OPERATOR < ( PROCEDURE = ulid_lt,
+	LEFTARG = ulid, RIGHTARG = ulid,
+	COMMUTATOR = >, NEGATOR = >=,
+	RESTRICT = ulid_ltsel, JOIN = scalarltjoinsel);
+CREATE OPERATOR >= ( PROCEDURE = ulid_ge,
+	LEFTARG = ulid, RIGHTARG = ulid,
+	COMMUTATOR = <=, NEGATOR = <,
+	RESTRICT = ulid_gesel, JOIN = scalargejoinsel);
+CREATE OPERATOR <= ( PROCEDURE = ulid_le,
+	LEFTARG = ulid, RIGHTARG = ulid,
+	COMMUTATOR = >=, NEGATOR = >,
+	RESTRICT = ulid_lesel, JOIN = scalarlejoinsel);
+CREATE OPERATOR = ( PROCEDURE = ulid_eq,
+	LEFTARG = ulid, RIGHTARG = ulid,
+	COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel,
+	HASHES, MERGES);
+
+CREATE OPERATOR CLASS ulid_ops DEFAULT FOR TYPE ulid USING btree AS
+       OPERATOR 1 <, OPERATOR 2 <=, OPERATOR 3 =, OPERATOR 4 >=, OPERATOR 5 >,
+       FUNCTION 1 ulid_cmp(ulid, ulid),
+       FUNCTION 2 ulid_sortsupport(internal);
+
+CREATE OPERATOR CLASS ulid_ops DEFAULT FOR TYPE ulid USING hash AS
+       OPERATOR 1 =, FUNCTION 1 ulid_hash(ulid), FUNCTION 2 ulid_hash_extended(ulid, bigint);
+
+CREATE FUNCTION ulid_lt_timestamptz(ulid, timestamptz)
+    RETURNS bool AS 'MODULE_PATHNAME', 'ulid_lt_timestamptz'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_ge_timestamptz(ulid, timestamptz)
+    RETURNS bool AS 'MODULE_PATHNAME', 'ulid_ge_timestamptz'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION timestamptz_gt_ulid(timestamptz, ulid)
+    RETURNS bool AS 'MODULE_PATHNAME', 'timestamptz_gt_ulid'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION timestamptz_le_ulid(timestamptz, ulid)
+    RETURNS bool AS 'MODULE_PATHNAME', 'timestamptz_le_ulid'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+CREATE FUNCTION ulid_cmp_timestamptz(ulid, timestamptz)
+    RETURNS int4 AS 'MODULE_PATHNAME', 'ulid_cmp_timestamptz'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- A ULID sorts just after the start of its millisecond and never equals a
+-- timestamp, so < and <= (and > and >=) are the same comparison
+CREATE OPERATOR < ( PROCEDURE = ulid_lt_timestamptz,
+	LEFTARG = ulid, RIGHTARG = timestamptz,
+	COMMUTATOR = >, NEGATOR = >=,
+	RESTRICT = ulid_ltsel, JOIN = scalarltjoinsel);
+CREATE OPERATOR <= ( PROCEDURE = ulid_lt_timestamptz,
+	LEFTARG = ulid, RIGHTARG = timestamptz,
+	COMMUTATOR = >=, NEGATOR = >,
+	RESTRICT = ulid_lesel, JOIN = scalarlejoinsel);
+CREATE OPERATOR >= ( PROCEDURE = ulid_ge_timestamptz,
+	LEFTARG = ulid, RIGHTARG = timestamptz,
+	COMMUTATOR = <=, NEGATOR = <,
+	RESTRICT = ulid_gesel, JOIN = scalargejoinsel);
+CREATE OPERATOR > ( PROCEDURE = ulid_ge_timestamptz,
+	LEFTARG = ulid, RIGHTARG = timestamptz,
+	COMMUTATOR = <, NEGATOR = <=,
+	RESTRICT = ulid_gtsel, JOIN = scalargtjoinsel);
+CREATE OPERATOR > ( PROCEDURE = timestamptz_gt_ulid,
+	LEFTARG = timestamptz, RIGHTARG = ulid,
+	COMMUTATOR = <, NEGATOR = <=,
+	RESTRICT = ulid_gtsel, JOIN = scalargtjoinsel);
+CREATE OPERATOR >= ( PROCEDURE = timestamptz_gt_ulid,
+	LEFTARG = timestamptz, RIGHTARG = ulid,
+	COMMUTATOR = <=, NEGATOR = <,
+	RESTRICT = ulid_gesel, JOIN = scalargejoinsel);
+CREATE OPERATOR <= ( PROCEDURE = timestamptz_le_ulid,
+	LEFTARG = timestamptz, RIGHTARG = ulid,
+	COMMUTATOR = >=, NEGATOR = >,
+	RESTRICT = ulid_lesel, JOIN = scalarlejoinsel);
+CREATE OPERATOR < ( PROCEDURE = timestamptz_le_ulid,
+	LEFTARG = timestamptz, RIGHTARG = ulid,
+	COMMUTATOR = >, NEGATOR = >=,
+	RESTRICT = ulid_ltsel, JOIN = scalarltjoinsel);
+
+-- The timestamptz-first operators reach the index through their commutators
+ALTER OPERATOR FAMILY ulid_ops USING btree ADD
+       OPERATOR 1 < (ulid, timestamptz), OPERATOR 2 <= (ulid, timestamptz),
+       OPERATOR 4 >= (ulid, timestamptz), OPERATOR 5 > (ulid, timestamptz),
+       FUNCTION 1 ulid_cmp_timestamptz(ulid, timestamptz);
+
+-- Documentation comments
+COMMENT ON TYPE ulid IS 'Universally Unique Lexicographically Sortable Identifier (ULID) - 128-bit identifier with timestamp and randomness';
+COMMENT ON FUNCTION ulid_to_text(ulid) IS 'Convert a ULID to its text representation';
+COMMENT ON FUNCTION ulid_from_text(text) IS 'Convert text to a ULID';
+COMMENT ON FUNCTION ulid_to_uuid(ulid) IS 'Reinterpret the 16 bytes of a ULID as a UUID';
+COMMENT ON FUNCTION ulid_from_uuid(uuid) IS 'Reinterpret the 16 bytes of a UUID as a ULID';
+COMMENT ON FUNCTION ulid_to_bytea(ulid) IS 'Convert a ULID to its 16 bytes';
+COMMENT ON FUNCTION ulid_from_bytea(bytea) IS 'Convert 16 bytes to a ULID';
+COMMENT ON FUNCTION ulid_array_to_text(ulid[]) IS 'Convert an array of ULIDs to an array of text in one pass';
+COMMENT ON FUNCTION ulid_array_from_text(text[]) IS 'Convert an array of text to an array of ULIDs in one pass';
+COMMENT ON FUNCTION ulid_array_out(ulid[]) IS 'Text representation of an array of ULIDs, as produced by array_out';
+COMMENT ON FUNCTION jsonb_ulid(jsonb, text) IS 'Extract a ULID stored as a string under the given key, like (doc ->> key)::ulid';
+COMMENT ON FUNCTION ulid_from_jsonb(jsonb) IS 'Convert a jsonb string to a ULID';
+COMMENT ON FUNCTION ulid_to_jsonb(ulid) IS 'Convert a ULID to a jsonb string';
+COMMENT ON FUNCTION ulid_to_uuidv7(ulid) IS 'Convert a ULID to a UUIDv7 with the same timestamp, preserving sort order';
+COMMENT ON FUNCTION uuidv7_to_ulid(uuid) IS 'Convert a UUIDv7 to a ULID with the same timestamp, preserving sort order';
+COMMENT ON FUNCTION gen_random_ulid() IS 'Generate a random ULID with embedded millisecond timestamp';
+COMMENT ON FUNCTION gen_random_ulid_v7compat() IS 'Generate a random ULID whose bytes are also a valid UUIDv7';
+COMMENT ON FUNCTION gen_monotonic_ulid() IS 'Generate a ULID that sorts after every ULID previously generated by this function in the session';
+COMMENT ON FUNCTION gen_statement_ulid() IS 'Generate a ULID stamped with the statement start time, increasing within the statement';
+COMMENT ON FUNCTION gen_ulid_at(timestamptz) IS 'Generate a random ULID with the given timestamp';
+COMMENT ON FUNCTION gen_monotonic_ulid_at(timestamptz) IS 'Generate a ULID with the given timestamp, increasing within the same millisecond';
+COMMENT ON FUNCTION gen_random_ulids(int4) IS 'Generate a sorted batch of ULIDs sharing one timestamp';
+COMMENT ON FUNCTION gen_random_ulid_array(int4) IS 'Generate a sorted batch of ULIDs sharing one timestamp as an array';
+COMMENT ON FUNCTION gen_shared_ulid() IS 'Generate a ULID that sorts after every ULID previously generated by this function in the instance (requires shared_preload_libraries)';
+COMMENT ON FUNCTION ulid_shared_retries() IS 'Number of compare-and-swap retries of gen_shared_ulid() and gen_node_ulid() since server start';
+COMMENT ON FUNCTION gen_node_ulid() IS 'Generate a ULID embedding ulid.node_id in the high bits of its random component';
+COMMENT ON FUNCTION ulid_node_id(ulid, int4) IS 'Extract the node identifier stored in the given number of high random-component bits';
+COMMENT ON FUNCTION ulid_node_id(ulid) IS 'Extract the node identifier using the current ulid.node_bits';
+COMMENT ON FUNCTION ulid_timestamp(ulid) IS 'Extract the timestamp embedded in a ULID';
+COMMENT ON FUNCTION ulid_min_at(timestamptz) IS 'Smallest ULID in the millisecond of the given timestamp';
+COMMENT ON FUNCTION ulid_max_at(timestamptz) IS 'Largest ULID in the millisecond of the given timestamp';
+COMMENT ON FUNCTION ulid_time_between(ulid, timestamptz, timestamptz) IS 'True if the timestamp of a ULID lies in the given range, inclusive; can use a btree index on the ULID';
+COMMENT ON FUNCTION ulid_cmp(ulid, ulid) IS 'Compare two ULIDs for sorting';
+COMMENT ON FUNCTION ulid_cmp_timestamptz(ulid, timestamptz) IS 'Compare a ULID with a timestamp for sorting; a ULID sorts just after the start of its millisecond';
+COMMENT ON OPERATOR CLASS ulid_ops USING btree IS 'B-tree operator class for ULID with optimized sorting support';
+COMMENT ON OPERATOR CLASS ulid_ops USING hash IS 'Hash operator class for ULID equality operations';
@@ -19,10 +19,30 @@
 
 #include "postgres.h"
 #include "ulid.h"
+#include "access/htup_details.h"
+#include "access/stratnum.h"
+#include "access/tupmacs.h"
+#include "access/xact.h"
+#include "catalog/pg_am.h"
+#include "catalog/pg_statistic.h"
+#include "catalog/pg_type.h"
+#include "commands/defrem.h"
+#include "commands/vacuum.h"
 #include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "port/atomics.h"
 #include "port/pg_bswap.h"
 #include "lib/stringinfo.h"
 #include "libpq/pqformat.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "nodes/pathnodes.h"
+#include "nodes/supportnodes.h"
+#include "optimizer/optimizer.h"
+#include "parser/parse_func.h"
+#include "postmaster/autovacuum.h"
 
 /* PostgreSQL 12 has hash functions in access/hash.h */
 #if PG_VERSION_NUM >= 130000
@@ -31,13 +51,63 @@
 #include "access/hash.h"
 #endif
 
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
 #include "utils/sortsupport.h"
 #include "utils/guc.h"
+#include "utils/jsonb.h"
 #include "lib/hyperloglog.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/selfuncs.h"
+#include "utils/timestamp.h"
+#include "utils/uuid.h"
 
 #include <time.h>
 
+/*
+ * Soft error reporting (errsave/ereturn) appeared in PostgreSQL 16.  Older
+ * servers have no error context to save into, so report the error directly.
+ */
+#if PG_VERSION_NUM < 160000
+#define ereturn(context, dummy_value, ...)                                     \
+	do {                                                                       \
+		(void)(context);                                                       \
+		ereport(ERROR, (__VA_ARGS__));                                         \
+		return dummy_value;                                                    \
+	} while (0)
+#endif
+
+/*
+ * The statistics target of a column being analyzed moved from its
+ * pg_attribute row into VacAttrStats in PostgreSQL 17
+ */
+#if PG_VERSION_NUM >= 170000
+#define ULID_STATS_TARGET(stats) ((stats)->attstattarget)
+#else
+#define ULID_STATS_TARGET(stats) ((stats)->attr->attstattarget)
+#endif
+
+/* is_pseudo_constant_for_index() takes the PlannerInfo since PostgreSQL 14 */
+#if PG_VERSION_NUM < 140000
+#define is_pseudo_constant_for_index(root, expr, index)                        \
+	is_pseudo_constant_for_index(expr, index)
+#endif
+
+/*
+ * SIMD codec paths are built for x86-64 with GCC or Clang, which can compile
+ * individual functions for a given instruction set and report CPU support at
+ * run time.  Everything else uses the scalar code only.
+ */
+#if defined(__x86_64__) && defined(__GNUC__)
+#define ULID_X86_SIMD
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 PG_MODULE_MAGIC;
 
 /* sortsupport for ulid */
@@ -48,6 +118,128 @@ typedef struct {
 	hyperLogLogState abbr_card; /* cardinality estimator */
 } ulid_sortsupport_state;
 
+/*
+ * Per-backend state for monotonic generation.  The 80-bit random component
+ * of the last issued ULID is kept as a 16-bit high and a 64-bit low part so
+ * that it can be incremented without 128-bit arithmetic.
+ */
+typedef struct {
+	uint64 last_ms; /* timestamp of the last issued ULID */
+	uint16 rand_hi; /* bits 79-64 of the random component */
+	uint64 rand_lo; /* bits 63-0 of the random component */
+	bool valid;     /* false until the first ULID has been issued */
+} ulid_monotonic_state;
+
+static ulid_monotonic_state monotonic_state = {0, 0, 0, false};
+static ulid_monotonic_state statement_state = {0, 0, 0, false};
+static ulid_monotonic_state keyed_state = {0, 0, 0, false};
+
+/*
+ * Per-backend counter for gen_node_ulid().  It holds only the low
+ * (80 - ulid.node_bits) bits of the random component; the node identifier is
+ * merged in when the ULID is assembled.  Changing ulid.node_id or
+ * ulid.node_bits invalidates it.
+ */
+static ulid_monotonic_state node_state = {0, 0, 0, false};
+
+/*
+ * Per-backend buffer of random bytes.  pg_strong_random() costs a library
+ * call or syscall per invocation, so random bytes are requested in blocks of
+ * ulid.entropy_pool_size bytes and handed out in small slices.  Bytes are
+ * zeroed as soon as they are handed out.
+ *
+ * The pool remembers the process that filled it; a forked child (e.g. a
+ * backend started from a postmaster that preloaded this library) discards
+ * the inherited contents and refills before first use.
+ */
+static unsigned char *entropy_pool = NULL;
+static int entropy_pool_alloc = 0; /* allocated size of entropy_pool */
+static int entropy_pool_len = 0;   /* number of valid bytes in the pool */
+static int entropy_pool_pos = 0;   /* offset of the next unused byte */
+static int entropy_pool_pid = 0;   /* MyProcPid of the process that filled it */
+
+/* Sources for the random component of generated ULIDs */
+typedef enum {
+	ULID_RANDOM_STRONG, /* pg_strong_random() */
+	ULID_RANDOM_CHACHA  /* per-backend ChaCha20 keystream */
+} ulid_random_source;
+
+static const struct config_enum_entry random_source_options[] = {
+	{"strong", ULID_RANDOM_STRONG, false},
+	{"chacha", ULID_RANDOM_CHACHA, false},
+	{NULL, 0, false}};
+
+/* Clocks for the timestamp of generated ULIDs */
+typedef enum {
+	ULID_CLOCK_REALTIME,       /* CLOCK_REALTIME */
+	ULID_CLOCK_REALTIME_COARSE /* CLOCK_REALTIME_COARSE, where available */
+} ulid_clock_source;
+
+static const struct config_enum_entry clock_source_options[] = {
+	{"realtime", ULID_CLOCK_REALTIME, false},
+	{"realtime_coarse", ULID_CLOCK_REALTIME_COARSE, false},
+	{NULL, 0, false}};
+
+/*
+ * Per-backend ChaCha20 generator (RFC 8439 block function).  It is seeded
+ * from pg_strong_random() on first use in each process and reseeded after
+ * ULID_CHACHA_RESEED_BYTES bytes of output.  After every request the next
+ * keystream block replaces the key and nonce ("fast key erasure"), so bytes
+ * already handed out cannot be reconstructed from the state.
+ */
+typedef struct {
+	uint32 input[16]; /* constants, key, block counter and nonce */
+	uint64 generated; /* bytes produced since the last reseed */
+	int pid;          /* MyProcPid of the process that seeded it, or 0 */
+} ulid_chacha_state;
+
+static ulid_chacha_state chacha_state = {{0}, 0, 0};
+
+/*
+ * Instance-wide generator state in shared memory, available when the library
+ * is loaded via shared_preload_libraries.
+ *
+ * The first 64 bits of every ULID issued by gen_shared_ulid() are the 48-bit
+ * timestamp followed by a 16-bit sequence number, and that word is advanced
+ * with a single 64-bit compare-and-swap, so no lock is taken and the issued
+ * ULIDs are strictly increasing across all backends.  The remaining 64 bits
+ * are random.  gen_node_ulid() advances a word of its own the same way.
+ */
+typedef struct {
+	pg_atomic_uint64 clock;      /* (ms << 16) | sequence of the last ULID */
+	pg_atomic_uint64 node_clock; /* the same for gen_node_ulid() */
+	pg_atomic_uint64 retries;    /* failed compare-and-swap attempts */
+} ulid_shared_state;
+
+static ulid_shared_state *shared_state = NULL;
+
+#if PG_VERSION_NUM >= 150000
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+#endif
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+/* Wait event reported while retrying the compare-and-swap */
+static uint32 shared_wait_event_info = 0;
+
+/* GUC variables */
+static int ulid_entropy_pool_size = ULID_ENTROPY_POOL_DEFAULT;
+static int ulid_random_source_guc = ULID_RANDOM_STRONG;
+static int ulid_clock_source_guc = ULID_CLOCK_REALTIME;
+static int ulid_node_id = -1;
+static int ulid_node_bits = ULID_NODE_BITS_DEFAULT;
+static bool ulid_fast_codec = true;
+
+/*
+ * Vectorized decoder, chosen in _PG_init() according to the CPU, or NULL if
+ * none is available.  It returns false without reporting an error if the
+ * input is not a valid ULID, leaving the diagnosis to the scalar decoder.
+ */
+static bool (*ulid_decode_fast)(const unsigned char *src,
+                                pg_ulid_t *ulid) = NULL;
+
+/* Vectorized encoder chosen in _PG_init(), or NULL if none is available */
+static void (*ulid_encode_fast)(const pg_ulid_t *ulid, char *dst) = NULL;
+
 /*
  * Unsigned datum comparator for sort support  (abbreviated keys).
  * Compares two Datum values as unsigned integers.
@@ -62,9 +254,53 @@ static int ulid_abbrev_cmp(Datum x, Datum y, SortSupport ssup) {
 	return 0;
 }
 
+void _PG_init(void);
+static void ulid_random_source_assign(int newval, void *extra);
+static void ulid_node_assign(int newval, void *extra);
+#ifdef ULID_X86_SIMD
+static bool ulid_decode_ssse3(const unsigned char *src, pg_ulid_t *ulid);
+static void ulid_encode_ssse3(const pg_ulid_t *ulid, char *dst);
+static void ulid_encode_bmi2(const pg_ulid_t *ulid, char *dst);
+static bool ulid_pdep_is_fast(void);
+#endif
+#if PG_VERSION_NUM >= 150000
+static void ulid_shmem_request(void);
+#endif
+static void ulid_shmem_startup(void);
 Datum ulid_in(PG_FUNCTION_ARGS);
 Datum ulid_out(PG_FUNCTION_ARGS);
+Datum ulid_to_text(PG_FUNCTION_ARGS);
+Datum ulid_from_text(PG_FUNCTION_ARGS);
+Datum ulid_to_uuid(PG_FUNCTION_ARGS);
+Datum ulid_from_uuid(PG_FUNCTION_ARGS);
+Datum ulid_to_uuidv7(PG_FUNCTION_ARGS);
+Datum uuidv7_to_ulid(PG_FUNCTION_ARGS);
+Datum ulid_to_bytea(PG_FUNCTION_ARGS);
+Datum ulid_from_bytea(PG_FUNCTION_ARGS);
+Datum ulid_array_to_text(PG_FUNCTION_ARGS);
+Datum ulid_array_from_text(PG_FUNCTION_ARGS);
+Datum ulid_array_out(PG_FUNCTION_ARGS);
+Datum jsonb_ulid(PG_FUNCTION_ARGS);
+Datum ulid_from_jsonb(PG_FUNCTION_ARGS);
+Datum ulid_to_jsonb(PG_FUNCTION_ARGS);
 Datum gen_random_ulid(PG_FUNCTION_ARGS);
+Datum gen_random_ulid_v7compat(PG_FUNCTION_ARGS);
+Datum gen_monotonic_ulid(PG_FUNCTION_ARGS);
+Datum gen_statement_ulid(PG_FUNCTION_ARGS);
+Datum gen_ulid_at(PG_FUNCTION_ARGS);
+Datum gen_monotonic_ulid_at(PG_FUNCTION_ARGS);
+Datum gen_random_ulids(PG_FUNCTION_ARGS);
+Datum gen_random_ulid_array(PG_FUNCTION_ARGS);
+Datum gen_shared_ulid(PG_FUNCTION_ARGS);
+Datum ulid_shared_retries(PG_FUNCTION_ARGS);
+Datum gen_node_ulid(PG_FUNCTION_ARGS);
+Datum ulid_node_id_bits(PG_FUNCTION_ARGS);
+Datum ulid_node_id_current(PG_FUNCTION_ARGS);
+Datum ulid_timestamp(PG_FUNCTION_ARGS);
+Datum ulid_min_at(PG_FUNCTION_ARGS);
+Datum ulid_max_at(PG_FUNCTION_ARGS);
+Datum ulid_time_between(PG_FUNCTION_ARGS);
+Datum ulid_time_support(PG_FUNCTION_ARGS);
 Datum ulid_recv(PG_FUNCTION_ARGS);
 Datum ulid_send(PG_FUNCTION_ARGS);
 Datum ulid_lt(PG_FUNCTION_ARGS);
@@ -74,16 +310,144 @@ Datum ulid_ge(PG_FUNCTION_ARGS);
 Datum ulid_gt(PG_FUNCTION_ARGS);
 Datum ulid_ne(PG_FUNCTION_ARGS);
 Datum ulid_cmp(PG_FUNCTION_ARGS);
+Datum ulid_lt_timestamptz(PG_FUNCTION_ARGS);
+Datum ulid_ge_timestamptz(PG_FUNCTION_ARGS);
+Datum timestamptz_gt_ulid(PG_FUNCTION_ARGS);
+Datum timestamptz_le_ulid(PG_FUNCTION_ARGS);
+Datum ulid_cmp_timestamptz(PG_FUNCTION_ARGS);
+Datum ulid_ltsel(PG_FUNCTION_ARGS);
+Datum ulid_lesel(PG_FUNCTION_ARGS);
+Datum ulid_gtsel(PG_FUNCTION_ARGS);
+Datum ulid_gesel(PG_FUNCTION_ARGS);
+Datum ulid_typanalyze(PG_FUNCTION_ARGS);
 Datum ulid_hash(PG_FUNCTION_ARGS);
 Datum ulid_hash_extended(PG_FUNCTION_ARGS);
 Datum ulid_sortsupport(PG_FUNCTION_ARGS);
 static void string_to_ulid(const char *source, pg_ulid_t *ulid,
                            struct Node *escontext);
+static inline bool ulid_decode(const unsigned char *src, pg_ulid_t *ulid);
+static void ulid_input_error(const char *source, size_t len,
+                             struct Node *escontext);
 static int ulid_fast_cmp(Datum x, Datum y, SortSupport ssup);
 static bool ulid_abbrev_abort(int memtupcount, SortSupport ssup);
 static Datum ulid_abbrev_convert(Datum original, SortSupport ssup);
 
 
+/*
+ * Module load callback
+ */
+void _PG_init(void) {
+	DefineCustomIntVariable(
+		"ulid.entropy_pool_size",
+		"Size of the per-backend buffer of random bytes used for ULID "
+		"generation.",
+		"Random bytes are requested from pg_strong_random() in blocks of this "
+		"size. Zero requests them separately for every ULID.",
+		&ulid_entropy_pool_size, ULID_ENTROPY_POOL_DEFAULT, 0,
+		ULID_ENTROPY_POOL_MAX, PGC_USERSET, GUC_UNIT_BYTE, NULL, NULL, NULL);
+
+	DefineCustomEnumVariable(
+		"ulid.random_source",
+		"Source of the random component of generated ULIDs.",
+		"\"strong\" uses pg_strong_random(); \"chacha\" uses a per-backend "
+		"ChaCha20 generator seeded from pg_strong_random().",
+		&ulid_random_source_guc, ULID_RANDOM_STRONG, random_source_options,
+		PGC_USERSET, 0, NULL, ulid_random_source_assign, NULL);
+
+	DefineCustomEnumVariable(
+		"ulid.clock_source", "Clock used for the timestamp of generated ULIDs.",
+		"\"realtime_coarse\" is cheaper to read but only advances every few "
+		"milliseconds; it falls back to \"realtime\" where unavailable.",
+		&ulid_clock_source_guc, ULID_CLOCK_REALTIME, clock_source_options,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+	DefineCustomIntVariable(
+		"ulid.node_id", "Node identifier embedded by gen_node_ulid().",
+		"Stored in the high ulid.node_bits bits of the random component. -1 "
+		"means unset; gen_node_ulid() raises an error until it is set.",
+		&ulid_node_id, -1, -1, PG_INT32_MAX, PGC_SUSET, 0, NULL,
+		ulid_node_assign, NULL);
+
+	DefineCustomIntVariable(
+		"ulid.node_bits",
+		"Number of random-component bits reserved for the node identifier.",
+		"The remaining bits of the 80-bit random component hold a counter.",
+		&ulid_node_bits, ULID_NODE_BITS_DEFAULT, 1, ULID_NODE_BITS_MAX,
+		PGC_SUSET, 0, NULL, ulid_node_assign, NULL);
+
+	DefineCustomBoolVariable(
+		"ulid.fast_codec",
+		"Use SIMD instructions to convert ULIDs to and from text where "
+		"available.",
+		"When off, the portable scalar code is used.", &ulid_fast_codec, true,
+		PGC_USERSET, 0, NULL, NULL, NULL);
+
+#if PG_VERSION_NUM >= 150000
+	MarkGUCPrefixReserved("ulid");
+#else
+	EmitWarningsOnPlaceholders("ulid");
+#endif
+
+#ifdef ULID_X86_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("ssse3")) {
+		ulid_decode_fast = ulid_decode_ssse3;
+		ulid_encode_fast = ulid_encode_ssse3;
+		if (__builtin_cpu_supports("bmi2") && ulid_pdep_is_fast()) {
+			ulid_encode_fast = ulid_encode_bmi2;
+		}
+	}
+#endif
+
+	/* The shared generator is only available when preloaded */
+	if (process_shared_preload_libraries_in_progress) {
+#if PG_VERSION_NUM >= 150000
+		prev_shmem_request_hook = shmem_request_hook;
+		shmem_request_hook = ulid_shmem_request;
+#else
+		RequestAddinShmemSpace(MAXALIGN(sizeof(ulid_shared_state)));
+#endif
+		prev_shmem_startup_hook = shmem_startup_hook;
+		shmem_startup_hook = ulid_shmem_startup;
+	}
+}
+
+#if PG_VERSION_NUM >= 150000
+/*
+ * shmem_request hook: request shared memory for the shared generator.
+ */
+static void ulid_shmem_request(void) {
+	if (prev_shmem_request_hook) {
+		prev_shmem_request_hook();
+	}
+
+	RequestAddinShmemSpace(MAXALIGN(sizeof(ulid_shared_state)));
+}
+#endif
+
+/*
+ * shmem_startup hook: allocate or attach to the shared generator state.
+ */
+static void ulid_shmem_startup(void) {
+	bool found;
+
+	if (prev_shmem_startup_hook) {
+		prev_shmem_startup_hook();
+	}
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+	shared_state =
+		ShmemInitStruct("pg_ulid", sizeof(ulid_shared_state), &found);
+	if (!found) {
+		pg_atomic_init_u64(&shared_state->clock, 0);
+		pg_atomic_init_u64(&shared_state->node_clock, 0);
+		pg_atomic_init_u64(&shared_state->retries, 0);
+	}
+
+	LWLockRelease(AddinShmemInitLock);
+}
+
 PG_FUNCTION_INFO_V1(ulid_in);
 Datum ulid_in(PG_FUNCTION_ARGS) {
 	char *ulid_str = PG_GETARG_CSTRING(0);
@@ -94,11 +458,11 @@ Datum ulid_in(PG_FUNCTION_ARGS) {
 	PG_RETURN_ULID_P(ulid);
 }
 
-PG_FUNCTION_INFO_V1(ulid_out);
-Datum ulid_out(PG_FUNCTION_ARGS) {
-	pg_ulid_t *ulid = PG_GETARG_ULID_P(0);
-	char *ulid_str = (char *)palloc(ULID_ENCODED_LEN + 1);
-
+/*
+ * Portable encoder: writes the 26-character Crockford base32 form of a ULID
+ * and a terminating NUL to ulid_str.
+ */
+static void ulid_encode_scalar(const pg_ulid_t *ulid, char *ulid_str) {
 	/*
 	 * Convert 16-byte ULID to 26-character Crockford base32 string.
 	 * Algorithm: Extract 5-bit chunks from the byte array and map to base32.
@@ -153,173 +517,2417 @@ Datum ulid_out(PG_FUNCTION_ARGS) {
 	ulid_str[25] = C32_ENCODING[ulid->data[15] & 31];
 
 	ulid_str[26] = '\0';
+}
+
+/*
+ * Writes the 26-character Crockford base32 form of a ULID and a terminating
+ * NUL to dst, using the vectorized encoder when available and enabled.
+ */
+static void ulid_encode(const pg_ulid_t *ulid, char *dst) {
+	if (ulid_fast_codec && ulid_encode_fast != NULL) {
+		ulid_encode_fast(ulid, dst);
+	} else {
+		ulid_encode_scalar(ulid, dst);
+	}
+}
+
+PG_FUNCTION_INFO_V1(ulid_out);
+Datum ulid_out(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid = PG_GETARG_ULID_P(0);
+	char *ulid_str = (char *)palloc(ULID_ENCODED_LEN + 1);
+
+	ulid_encode(ulid, ulid_str);
 
 	PG_RETURN_CSTRING(ulid_str);
 }
 
+/*
+ * Cast to text or varchar: encodes straight into the payload of a text
+ * datum instead of going through ulid_out() and a second copy.  One spare
+ * byte receives the encoder's terminating NUL.
+ */
+PG_FUNCTION_INFO_V1(ulid_to_text);
+Datum ulid_to_text(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid = PG_GETARG_ULID_P(0);
+	text *result = (text *)palloc(VARHDRSZ + ULID_ENCODED_LEN + 1);
+
+	SET_VARSIZE(result, VARHDRSZ + ULID_ENCODED_LEN);
+	ulid_encode(ulid, VARDATA(result));
+
+	PG_RETURN_TEXT_P(result);
+}
 
 /*
- * Converts Crockford base32 string to the internal 16-byte binary
- * representation.
- *
- * Crockford base32 uses: 0-9, A-Z (excluding I, L, O, U)
- * Each character represents 5 bits.
- * 26 characters * 5 bits = 130 bits, but only 128 bits are used.
+ * Cast from text or varchar: decodes the payload in place, without making
+ * a NUL-terminated copy.
  */
-static void string_to_ulid(const char *source, pg_ulid_t *ulid,
-                           struct Node *escontext) {
-	const unsigned char *src = (const unsigned char *)source;
+PG_FUNCTION_INFO_V1(ulid_from_text);
+Datum ulid_from_text(PG_FUNCTION_ARGS) {
+	text *txt = PG_GETARG_TEXT_PP(0);
+	const char *src = VARDATA_ANY(txt);
+	size_t len = VARSIZE_ANY_EXHDR(txt);
+	pg_ulid_t *ulid = (pg_ulid_t *)palloc(sizeof(*ulid));
+
+	if (len != ULID_ENCODED_LEN ||
+	    !ulid_decode((const unsigned char *)src, ulid)) {
+		ulid_input_error(src, len, fcinfo->context);
+	}
+
+	PG_RETURN_ULID_P(ulid);
+}
+
+/*
+ * Casts between ulid and uuid.  Both types are 16 bytes in the same order,
+ * so the conversion is a single copy; it cannot be declared binary
+ * coercible because ulid is double-aligned and uuid is not.
+ */
+PG_FUNCTION_INFO_V1(ulid_to_uuid);
+Datum ulid_to_uuid(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid = PG_GETARG_ULID_P(0);
+	pg_uuid_t *uuid = (pg_uuid_t *)palloc(UUID_LEN);
+
+	memcpy(uuid->data, ulid->data, UUID_LEN);
+	PG_RETURN_UUID_P(uuid);
+}
+
+PG_FUNCTION_INFO_V1(ulid_from_uuid);
+Datum ulid_from_uuid(PG_FUNCTION_ARGS) {
+	pg_uuid_t *uuid = PG_GETARG_UUID_P(0);
+	pg_ulid_t *ulid = (pg_ulid_t *)palloc(ULID_LEN);
+
+	memcpy(ulid->data, uuid->data, ULID_LEN);
+	PG_RETURN_ULID_P(ulid);
+}
+
+/*
+ * Returns overhead + nelems * elemsize, the size of a single allocation
+ * holding an array result, or raises an error if it would exceed
+ * MaxAllocSize.
+ */
+static Size ulid_array_alloc_size(Size overhead, Size nelems, Size elemsize) {
+	if (nelems > (MaxAllocSize - overhead) / elemsize) {
+		ereport(ERROR,
+		        (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+		         errmsg("array size exceeds the maximum allowed (%d)",
+		                (int)((MaxAllocSize - overhead) / elemsize))));
+	}
+	return overhead + nelems * elemsize;
+}
 
-	/* Parameter reserved for soft error handling in PostgreSQL 16+ */
-	(void)escontext;
+/* Size of the header of an array shaped like source, up to its data */
+static Size ulid_array_header_size(ArrayType *source, int nitems) {
+	return ARR_HASNULL(source) ? ARR_OVERHEAD_WITHNULLS(ARR_NDIM(source), nitems)
+	                           : ARR_OVERHEAD_NONULLS(ARR_NDIM(source));
+}
 
-	if (strlen(source) != ULID_ENCODED_LEN) {
-		ereport(ERROR, (errmsg("invalid ulid: incorrect length %d (expected %d)",
-		                       (int)strlen(source), ULID_ENCODED_LEN)));
+/*
+ * Starts a zeroed result array of nbytes with the shape and NULL bitmap of
+ * source.  nbytes must include the header from ulid_array_header_size().
+ */
+static ArrayType *ulid_array_like(ArrayType *source, int nitems, Size nbytes,
+                                  Oid elemtype) {
+	int ndim = ARR_NDIM(source);
+	bits8 *source_bitmap = ARR_NULLBITMAP(source);
+	ArrayType *result = (ArrayType *)palloc0(nbytes);
+	bits8 *result_bitmap;
+
+	SET_VARSIZE(result, nbytes);
+	result->ndim = ndim;
+	result->dataoffset =
+		source_bitmap ? ulid_array_header_size(source, nitems) : 0;
+	result->elemtype = elemtype;
+	memcpy(ARR_DIMS(result), ARR_DIMS(source), ndim * sizeof(int));
+	memcpy(ARR_LBOUND(result), ARR_LBOUND(source), ndim * sizeof(int));
+
+	result_bitmap = ARR_NULLBITMAP(result);
+	if (source_bitmap != NULL && result_bitmap != NULL) {
+		memcpy(result_bitmap, source_bitmap, (nitems + 7) / 8);
 	}
+	return result;
+}
 
-	/* Validate each character is valid Crockford base32 */
-	for (int i = 0; i < ULID_ENCODED_LEN; i++) {
-		if (DEC[src[i]] == 0xFF) {
-			ereport(ERROR,
-			        (errmsg("invalid ulid: bad character at position %d", i)));
+/* Counts the NULL elements of an array */
+static int ulid_array_count_nulls(ArrayType *array, int nitems) {
+	bits8 *bitmap = ARR_NULLBITMAP(array);
+	int nulls = 0;
+
+	if (bitmap == NULL) {
+		return 0;
+	}
+	for (int i = 0; i < nitems; i++) {
+		if (!(bitmap[i / 8] & (1 << (i % 8)))) {
+			nulls++;
 		}
 	}
+	return nulls;
+}
 
-	/* First character must be <= '7' to prevent 128-bit overflow */
-	if (src[0] > '7') {
-		ereport(ERROR,
-		        (errmsg("invalid ulid: value overflows 128 bit encoding")));
-	}
-
-	/* Decode timestamp (characters 0-9 -> bytes 0-5) */
-	ulid->data[0] = (DEC[src[0]] << 5) | DEC[src[1]];
-	ulid->data[1] = (DEC[src[2]] << 3) | (DEC[src[3]] >> 2);
-	ulid->data[2] =
-		(DEC[src[3]] << 6) | (DEC[src[4]] << 1) | (DEC[src[5]] >> 4);
-	ulid->data[3] = (DEC[src[5]] << 4) | (DEC[src[6]] >> 1);
-	ulid->data[4] =
-		(DEC[src[6]] << 7) | (DEC[src[7]] << 2) | (DEC[src[8]] >> 3);
-	ulid->data[5] = (DEC[src[8]] << 5) | DEC[src[9]];
-
-	/* Decode random component (characters 10-25 -> bytes 6-15) */
-	ulid->data[6] = (DEC[src[10]] << 3) | (DEC[src[11]] >> 2);
-	ulid->data[7] =
-		(DEC[src[11]] << 6) | (DEC[src[12]] << 1) | (DEC[src[13]] >> 4);
-	ulid->data[8] = (DEC[src[13]] << 4) | (DEC[src[14]] >> 1);
-	ulid->data[9] =
-		(DEC[src[14]] << 7) | (DEC[src[15]] << 2) | (DEC[src[16]] >> 3);
-	ulid->data[10] = (DEC[src[16]] << 5) | DEC[src[17]];
-	ulid->data[11] = (DEC[src[18]] << 3) | (DEC[src[19]] >> 2);
-	ulid->data[12] =
-		(DEC[src[19]] << 6) | (DEC[src[20]] << 1) | (DEC[src[21]] >> 4);
-	ulid->data[13] = (DEC[src[21]] << 4) | (DEC[src[22]] >> 1);
-	ulid->data[14] =
-		(DEC[src[22]] << 7) | (DEC[src[23]] << 2) | (DEC[src[24]] >> 3);
-	ulid->data[15] = (DEC[src[24]] << 5) | DEC[src[25]];
+/*
+ * Converts ulid[] to text[] in one pass.  The result, including every text
+ * element, is built in a single allocation; the element data of the input
+ * is a plain run of 16-byte values, since NULLs take no space.
+ */
+PG_FUNCTION_INFO_V1(ulid_array_to_text);
+Datum ulid_array_to_text(PG_FUNCTION_ARGS) {
+	ArrayType *source = PG_GETARG_ARRAYTYPE_P(0);
+	int nitems = ArrayGetNItems(ARR_NDIM(source), ARR_DIMS(source));
+	int nvalues = nitems - ulid_array_count_nulls(source, nitems);
+	Size element = INTALIGN(VARHDRSZ + ULID_ENCODED_LEN + 1);
+	Size header = ulid_array_header_size(source, nitems);
+	ArrayType *result;
+	const pg_ulid_t *ulids;
+	char *dst;
+
+	result = ulid_array_like(source, nitems,
+	                         ulid_array_alloc_size(header, nvalues, element),
+	                         TEXTOID);
+
+	ulids = (const pg_ulid_t *)ARR_DATA_PTR(source);
+	dst = ARR_DATA_PTR(result);
+	for (int i = 0; i < nvalues; i++) {
+		SET_VARSIZE(dst, VARHDRSZ + ULID_ENCODED_LEN);
+		ulid_encode(&ulids[i], VARDATA(dst));
+		dst += element;
+	}
+
+	PG_RETURN_ARRAYTYPE_P(result);
 }
 
-PG_FUNCTION_INFO_V1(gen_random_ulid);
-Datum gen_random_ulid(PG_FUNCTION_ARGS) {
-	pg_ulid_t *ulid = palloc(ULID_LEN);
-	struct timespec ts;
-	uint64_t tms;
+/*
+ * Converts text[] to ulid[] in one pass, decoding each element in place and
+ * writing the result into a single allocation.
+ */
+PG_FUNCTION_INFO_V1(ulid_array_from_text);
+Datum ulid_array_from_text(PG_FUNCTION_ARGS) {
+	ArrayType *source = PG_GETARG_ARRAYTYPE_P(0);
+	int nitems = ArrayGetNItems(ARR_NDIM(source), ARR_DIMS(source));
+	int nvalues = nitems - ulid_array_count_nulls(source, nitems);
+	Oid elemtype = get_element_type(get_fn_expr_rettype(fcinfo->flinfo));
+	Size header = ulid_array_header_size(source, nitems);
+	ArrayType *result;
+	pg_ulid_t *ulids;
+	char *ptr;
+
+	result = ulid_array_like(source, nitems,
+	                         ulid_array_alloc_size(header, nvalues, ULID_LEN),
+	                         elemtype);
+
+	ulids = (pg_ulid_t *)ARR_DATA_PTR(result);
+	ptr = ARR_DATA_PTR(source);
+	for (int i = 0; i < nvalues; i++) {
+		const char *src = VARDATA_ANY(ptr);
+		size_t len = VARSIZE_ANY_EXHDR(ptr);
+
+		if (len != ULID_ENCODED_LEN ||
+		    !ulid_decode((const unsigned char *)src, &ulids[i])) {
+			ulid_input_error(src, len, fcinfo->context);
+		}
+		ptr = att_addlength_pointer(ptr, -1, ptr);
+		ptr = (char *)att_align_nominal(ptr, 'i');
+	}
 
-	/*
-	 * Set first 48 bits to unix epoch timestamp
-	 */
-	if (clock_gettime(CLOCK_REALTIME, &ts) != 0) {
-		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-		                errmsg("could not get CLOCK_REALTIME")));
+	PG_RETURN_ARRAYTYPE_P(result);
+}
+
+/*
+ * Produces the same text as array_out() for a ulid[], in a single
+ * allocation and without calling ulid_out() per element.  ULIDs never need
+ * quoting, so the exact length is known before anything is written.
+ */
+PG_FUNCTION_INFO_V1(ulid_array_out);
+Datum ulid_array_out(PG_FUNCTION_ARGS) {
+	ArrayType *source = PG_GETARG_ARRAYTYPE_P(0);
+	int ndim = ARR_NDIM(source);
+	int *dims = ARR_DIMS(source);
+	int *lbs = ARR_LBOUND(source);
+	int nitems = ArrayGetNItems(ndim, dims);
+	int nnulls = ulid_array_count_nulls(source, nitems);
+	bits8 *bitmap = ARR_NULLBITMAP(source);
+	const pg_ulid_t *ulid = (const pg_ulid_t *)ARR_DATA_PTR(source);
+	char prefix[MAXDIM * 25 + 2]; /* "[lower:upper]" per dimension, "=" */
+	int prefix_len = 0;
+	int indx[MAXDIM];
+	Size len, groups = 1, separators = 0;
+	text *result;
+	char *p;
+
+	if (nitems == 0) {
+		PG_RETURN_TEXT_P(cstring_to_text("{}"));
+	}
+
+	/* Dimensions are only printed when some lower bound is not 1 */
+	for (int i = 0; i < ndim; i++) {
+		if (lbs[i] != 1) {
+			for (int j = 0; j < ndim; j++) {
+				prefix_len += sprintf(prefix + prefix_len, "[%d:%d]", lbs[j],
+				                      lbs[j] + dims[j] - 1);
+			}
+			prefix[prefix_len++] = '=';
+			break;
+		}
+	}
+
+	/* Each sub-array at every level has a pair of braces and n - 1 commas */
+	for (int i = 0; i < ndim; i++) {
+		separators += groups * (2 + (dims[i] - 1));
+		groups *= dims[i];
+	}
+	len = prefix_len + separators;
+	len = ulid_array_alloc_size(len + VARHDRSZ, nitems - nnulls,
+	                            ULID_ENCODED_LEN) +
+	      (Size)nnulls * 4;
+	if (len >= MaxAllocSize) {
+		ereport(ERROR,
+		        (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+		         errmsg("array size exceeds the maximum allowed (%d)",
+		                (int)MaxAllocSize)));
 	}
 
-	tms = ((uint64_t)ts.tv_sec * 1000) + ((uint64_t)ts.tv_nsec / 1000000);
-	tms = pg_hton64(tms << 16);
-	memcpy(&ulid->data[0], &tms, 6);
+	/* One spare byte: the encoder always writes a terminating NUL */
+	result = (text *)palloc(len + 1);
+	SET_VARSIZE(result, len);
+	p = VARDATA(result);
 
-	if (!pg_strong_random(&ulid->data[6], ULID_LEN - 6)) {
-		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
-		                errmsg("could not generate random values")));
+	memcpy(p, prefix, prefix_len);
+	p += prefix_len;
+	for (int i = 0; i < ndim; i++) {
+		indx[i] = 0;
+		*p++ = '{';
 	}
 
-	PG_RETURN_ULID_P(ulid);
+	for (int k = 0; k < nitems; k++) {
+		int i;
+
+		if (bitmap && !(bitmap[k / 8] & (1 << (k % 8)))) {
+			memcpy(p, "NULL", 4);
+			p += 4;
+		} else {
+			ulid_encode(ulid++, p);
+			p += ULID_ENCODED_LEN;
+		}
+
+		/* Close finished sub-arrays, then open the next ones */
+		for (i = ndim - 1; i >= 0; i--) {
+			if (++indx[i] < dims[i]) {
+				*p++ = ',';
+				break;
+			}
+			indx[i] = 0;
+			*p++ = '}';
+		}
+		if (i >= 0) {
+			for (i = i + 1; i < ndim; i++) {
+				*p++ = '{';
+			}
+		}
+	}
+
+	Assert(p == VARDATA(result) + len - VARHDRSZ);
+	PG_RETURN_TEXT_P(result);
 }
 
-PG_FUNCTION_INFO_V1(ulid_recv);
-Datum ulid_recv(PG_FUNCTION_ARGS) {
-	StringInfo buffer = (StringInfo)PG_GETARG_POINTER(0);
+/*
+ * Decodes a jsonb string value straight from the jsonb container, without
+ * materializing it as text or a C string first.
+ */
+static pg_ulid_t *ulid_from_jsonb_value(JsonbValue *value) {
 	pg_ulid_t *ulid;
+	const char *src;
+	size_t len;
 
-	ulid = (pg_ulid_t *)palloc(ULID_LEN);
-	memcpy(ulid->data, pq_getmsgbytes(buffer, ULID_LEN), ULID_LEN);
-	PG_RETURN_POINTER(ulid);
+	if (value->type != jbvString) {
+		ereport(ERROR,
+		        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+		         errmsg("cannot cast jsonb %s to type ulid",
+		                JsonbTypeName(value))));
+	}
+
+	src = value->val.string.val;
+	len = value->val.string.len;
+	ulid = (pg_ulid_t *)palloc(sizeof(*ulid));
+	if (len != ULID_ENCODED_LEN ||
+	    !ulid_decode((const unsigned char *)src, ulid)) {
+		ulid_input_error(src, len, NULL);
+	}
+	return ulid;
 }
 
-PG_FUNCTION_INFO_V1(ulid_send);
-Datum ulid_send(PG_FUNCTION_ARGS) {
-	pg_ulid_t *ulid = PG_GETARG_ULID_P(0);
-	StringInfoData buffer;
+/*
+ * Equivalent to (doc ->> key)::ulid: returns NULL if doc is not an object,
+ * has no such key or holds a JSON null there.
+ */
+PG_FUNCTION_INFO_V1(jsonb_ulid);
+Datum jsonb_ulid(PG_FUNCTION_ARGS) {
+	Jsonb *doc = PG_GETARG_JSONB_P(0);
+	text *key = PG_GETARG_TEXT_PP(1);
+	JsonbValue keyval;
+	JsonbValue *value;
+
+	keyval.type = jbvString;
+	keyval.val.string.val = VARDATA_ANY(key);
+	keyval.val.string.len = VARSIZE_ANY_EXHDR(key);
+
+	value = findJsonbValueFromContainer(&doc->root, JB_FOBJECT, &keyval);
+	if (value == NULL || value->type == jbvNull) {
+		PG_RETURN_NULL();
+	}
 
-	pq_begintypsend(&buffer);
-	pq_sendbytes(&buffer, (const char *)ulid->data, ULID_LEN);
-	PG_RETURN_BYTEA_P(pq_endtypsend(&buffer));
+	PG_RETURN_ULID_P(ulid_from_jsonb_value(value));
 }
 
-PG_FUNCTION_INFO_V1(ulid_lt);
-Datum ulid_lt(PG_FUNCTION_ARGS) {
-	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
-	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+/* Cast from a jsonb string; a JSON null becomes SQL NULL */
+PG_FUNCTION_INFO_V1(ulid_from_jsonb);
+Datum ulid_from_jsonb(PG_FUNCTION_ARGS) {
+	Jsonb *doc = PG_GETARG_JSONB_P(0);
+	JsonbValue *value;
 
-	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) < 0);
-}
+	if (!JB_ROOT_IS_SCALAR(doc)) {
+		ereport(ERROR,
+		        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+		         errmsg("cannot cast jsonb %s to type ulid",
+		                JB_ROOT_IS_OBJECT(doc) ? "object" : "array")));
+	}
 
-PG_FUNCTION_INFO_V1(ulid_le);
-Datum ulid_le(PG_FUNCTION_ARGS) {
-	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
-	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+	/* A scalar is stored as a one-element pseudo array */
+	value = getIthJsonbValueFromContainer(&doc->root, 0);
+	if (value->type == jbvNull) {
+		PG_RETURN_NULL();
+	}
 
-	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) <= 0);
+	PG_RETURN_ULID_P(ulid_from_jsonb_value(value));
 }
 
-PG_FUNCTION_INFO_V1(ulid_eq);
-Datum ulid_eq(PG_FUNCTION_ARGS) {
-	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
-	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+/* Cast to a jsonb string */
+PG_FUNCTION_INFO_V1(ulid_to_jsonb);
+Datum ulid_to_jsonb(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid = PG_GETARG_ULID_P(0);
+	char buf[ULID_ENCODED_LEN + 1];
+	JsonbValue value;
 
-	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) == 0);
+	ulid_encode(ulid, buf);
+	value.type = jbvString;
+	value.val.string.val = buf;
+	value.val.string.len = ULID_ENCODED_LEN;
+
+	PG_RETURN_JSONB_P(JsonbValueToJsonb(&value));
 }
 
-PG_FUNCTION_INFO_V1(ulid_ge);
-Datum ulid_ge(PG_FUNCTION_ARGS) {
-	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
-	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+/*
+ * UUIDv7 (RFC 9562) starts with the same 48-bit Unix millisecond timestamp
+ * as a ULID, but the 80 bits that follow hold a 4-bit version, 12 random
+ * bits, a 2-bit variant and 62 more random bits.  The conversions keep the
+ * timestamp and move the random bits around those fields in order: the top
+ * 74 of the ULID's 80 random bits fill the UUID's random bits and the lowest
+ * 6 are dropped (and come back as zero).  Both directions therefore preserve
+ * sort order, and uuidv7_to_ulid() followed by ulid_to_uuidv7() returns the
+ * original UUID.
+ */
+#define ULID_UUIDV7_VERSION UINT64CONST(0x7000)
+#define ULID_UUIDV7_VARIANT UINT64CONST(0x8000000000000000)
+#define ULID_UUIDV7_DROPPED_BITS 6
 
-	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) >= 0);
+PG_FUNCTION_INFO_V1(ulid_to_uuidv7);
+Datum ulid_to_uuidv7(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid = PG_GETARG_ULID_P(0);
+	pg_uuid_t *uuid = (pg_uuid_t *)palloc(UUID_LEN);
+	uint64 high, low;
+
+	memcpy(&high, &ulid->data[0], sizeof(uint64));
+	memcpy(&low, &ulid->data[8], sizeof(uint64));
+	high = pg_ntoh64(high);
+	low = pg_ntoh64(low);
+
+	/* Random bits 79-68 follow the version, bits 67-6 the variant */
+	low = ULID_UUIDV7_VARIANT | ((high & 0xF) << 58) |
+	      (low >> ULID_UUIDV7_DROPPED_BITS);
+	high = (high & ~UINT64CONST(0xFFFF)) | ULID_UUIDV7_VERSION |
+	       ((high >> 4) & 0xFFF);
+
+	high = pg_hton64(high);
+	low = pg_hton64(low);
+	memcpy(&uuid->data[0], &high, sizeof(uint64));
+	memcpy(&uuid->data[8], &low, sizeof(uint64));
+	PG_RETURN_UUID_P(uuid);
 }
 
-PG_FUNCTION_INFO_V1(ulid_gt);
-Datum ulid_gt(PG_FUNCTION_ARGS) {
-	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
-	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+PG_FUNCTION_INFO_V1(uuidv7_to_ulid);
+Datum uuidv7_to_ulid(PG_FUNCTION_ARGS) {
+	pg_uuid_t *uuid = PG_GETARG_UUID_P(0);
+	pg_ulid_t *ulid;
+	uint64 high, low;
 
-	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) > 0);
-}
+	if ((uuid->data[6] >> 4) != 7 || (uuid->data[8] >> 6) != 2) {
+		ereport(ERROR,
+		        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+		         errmsg("uuid is not a version 7 UUID"),
+		         errdetail("Found version %d, variant bits %d%d.",
+		                   uuid->data[6] >> 4, (uuid->data[8] >> 7) & 1,
+		                   (uuid->data[8] >> 6) & 1)));
+	}
 
-PG_FUNCTION_INFO_V1(ulid_ne);
-Datum ulid_ne(PG_FUNCTION_ARGS) {
-	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
-	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+	memcpy(&high, &uuid->data[0], sizeof(uint64));
+	memcpy(&low, &uuid->data[8], sizeof(uint64));
+	high = pg_ntoh64(high);
+	low = pg_ntoh64(low) & ~(UINT64CONST(3) << 62);
 
-	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) != 0);
+	high = (high & ~UINT64CONST(0xFFFF)) | ((high & 0xFFF) << 4) | (low >> 58);
+	low <<= ULID_UUIDV7_DROPPED_BITS;
+
+	ulid = (pg_ulid_t *)palloc(ULID_LEN);
+	high = pg_hton64(high);
+	low = pg_hton64(low);
+	memcpy(&ulid->data[0], &high, sizeof(uint64));
+	memcpy(&ulid->data[8], &low, sizeof(uint64));
+	PG_RETURN_ULID_P(ulid);
 }
 
-/* handler for btree index operator */
-PG_FUNCTION_INFO_V1(ulid_cmp);
-Datum ulid_cmp(PG_FUNCTION_ARGS) {
-	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
-	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+/*
+ * Casts between ulid and bytea: the 16 bytes of the ULID, most significant
+ * first, as sent by ulid_send().
+ */
+PG_FUNCTION_INFO_V1(ulid_to_bytea);
+Datum ulid_to_bytea(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid = PG_GETARG_ULID_P(0);
+	bytea *result = (bytea *)palloc(VARHDRSZ + ULID_LEN);
 
-	PG_RETURN_INT32(ulid_internal_cmp(arg1, arg2));
+	SET_VARSIZE(result, VARHDRSZ + ULID_LEN);
+	memcpy(VARDATA(result), ulid->data, ULID_LEN);
+	PG_RETURN_BYTEA_P(result);
+}
+
+PG_FUNCTION_INFO_V1(ulid_from_bytea);
+Datum ulid_from_bytea(PG_FUNCTION_ARGS) {
+	bytea *data = PG_GETARG_BYTEA_PP(0);
+	pg_ulid_t *ulid;
+
+	if (VARSIZE_ANY_EXHDR(data) != ULID_LEN) {
+		ereport(ERROR,
+		        (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+		         errmsg("invalid ulid: incorrect length %d bytes (expected %d)",
+		                (int)VARSIZE_ANY_EXHDR(data), ULID_LEN)));
+	}
+
+	ulid = (pg_ulid_t *)palloc(ULID_LEN);
+	memcpy(ulid->data, VARDATA_ANY(data), ULID_LEN);
+	PG_RETURN_ULID_P(ulid);
+}
+
+
+/*
+ * Converts Crockford base32 string to the internal 16-byte binary
+ * representation.
+ *
+ * Crockford base32 uses: 0-9, A-Z (excluding I, L, O, U)
+ * Each character represents 5 bits.
+ * 26 characters * 5 bits = 130 bits, but only 128 bits are used.
+ */
+#ifdef ULID_X86_SIMD
+/*
+ * Maps 16 Crockford base32 characters to their 5-bit values.  Lanes holding
+ * anything but a valid character get their high bit set in *invalid.
+ *
+ * The low nibble of each character indexes one of three 16-entry tables
+ * (pshufb); the high nibble selects the table: 3 for digits, 4 or 6 for
+ * A-O / a-o and 5 or 7 for P-Z / p-z.  Table entries for characters outside
+ * the alphabet are -1, and lanes no table applies to get 0x80.
+ */
+__attribute__((target("ssse3"))) static inline __m128i
+ulid_ssse3_values(__m128i c, __m128i *invalid) {
+	const __m128i digits = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, -1, -1,
+	                                     -1, -1, -1, -1);
+	const __m128i letters_a = _mm_setr_epi8(-1, 10, 11, 12, 13, 14, 15, 16,
+	                                        17, -1, 18, 19, -1, 20, 21, -1);
+	const __m128i letters_p = _mm_setr_epi8(22, 23, 24, 25, 26, -1, 27, 28, 29,
+	                                        30, 31, -1, -1, -1, -1, -1);
+	__m128i lo = _mm_and_si128(c, _mm_set1_epi8(0x0F));
+	__m128i hi = _mm_and_si128(_mm_srli_epi16(c, 4), _mm_set1_epi8(0x0F));
+	__m128i folded = _mm_or_si128(hi, _mm_set1_epi8(2));
+	__m128i in_digits = _mm_cmpeq_epi8(hi, _mm_set1_epi8(3));
+	__m128i in_a = _mm_cmpeq_epi8(folded, _mm_set1_epi8(6));
+	__m128i in_p = _mm_cmpeq_epi8(folded, _mm_set1_epi8(7));
+	__m128i selected = _mm_or_si128(_mm_or_si128(in_digits, in_a), in_p);
+	__m128i values = _mm_or_si128(
+		_mm_or_si128(_mm_and_si128(in_digits, _mm_shuffle_epi8(digits, lo)),
+	                 _mm_and_si128(in_a, _mm_shuffle_epi8(letters_a, lo))),
+		_mm_and_si128(in_p, _mm_shuffle_epi8(letters_p, lo)));
+
+	*invalid = _mm_or_si128(
+		*invalid, _mm_or_si128(values, _mm_andnot_si128(
+		                                   selected, _mm_set1_epi8(-128))));
+
+	return values;
+}
+
+/*
+ * Packs 16 5-bit values into two 40-bit integers, one per group of eight:
+ * pmaddubsw joins pairs into 10 bits, pmaddwd pairs of those into 20 bits,
+ * and a 32x32-bit multiply-add joins the last pairs into 40 bits.
+ */
+__attribute__((target("ssse3"))) static inline void
+ulid_ssse3_pack(__m128i values, uint64 *first, uint64 *second) {
+	__m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0120));
+	__m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00010400));
+	__m128i groups =
+		_mm_add_epi64(_mm_mul_epu32(quads, _mm_set1_epi32(1 << 20)),
+	                  _mm_srli_epi64(quads, 32));
+
+	*first = (uint64)_mm_cvtsi128_si64(groups);
+	*second = (uint64)_mm_cvtsi128_si64(_mm_unpackhi_epi64(groups, groups));
+}
+
+/*
+ * SSSE3 decoder for a string of exactly ULID_ENCODED_LEN characters.
+ *
+ * Characters 0-1 carry the top 8 bits and are decoded with the table;
+ * characters 2-25 form three groups of eight characters (40 bits each) and
+ * are validated and decoded by two overlapping 16-byte loads at offsets 2
+ * and 10, which stay within the 26 characters of the string.  The result is
+ * written as two 64-bit words rather than byte by byte.
+ */
+__attribute__((target("ssse3"))) static bool
+ulid_decode_ssse3(const unsigned char *src, pg_ulid_t *ulid) {
+	__m128i invalid = _mm_setzero_si128();
+	__m128i head = _mm_loadu_si128((const __m128i *)(src + 2));
+	__m128i tail = _mm_loadu_si128((const __m128i *)(src + 10));
+	uint64 group1, group2, group3;
+	uint64 top, bottom;
+
+	head = ulid_ssse3_values(head, &invalid);
+	tail = ulid_ssse3_values(tail, &invalid);
+
+	if (_mm_movemask_epi8(invalid) != 0 || DEC[src[1]] == 0xFF ||
+	    src[0] < '0' || src[0] > '7') {
+		return false;
+	}
+
+	ulid_ssse3_pack(head, &group1, &group2);
+	ulid_ssse3_pack(tail, &group2, &group3);
+
+	top = ((uint64)(((src[0] - '0') << 5) | DEC[src[1]]) << 56) |
+	      (group1 << 16) | (group2 >> 24);
+	bottom = (group2 << 40) | group3;
+	top = pg_hton64(top);
+	bottom = pg_hton64(bottom);
+	memcpy(&ulid->data[0], &top, sizeof(uint64));
+	memcpy(&ulid->data[8], &bottom, sizeof(uint64));
+
+	return true;
+}
+
+/*
+ * Reports whether PDEP is known to be implemented in hardware: on Intel, and
+ * on AMD from Zen 3 (family 19h).  Earlier AMD processors and Zen 1 derived
+ * ones such as Hygon Dhyana (family 18h) run it in microcode, taking
+ * hundreds of cycles, so other vendors are treated as slow too.
+ */
+static bool ulid_pdep_is_fast(void) {
+	unsigned int eax, ebx, ecx, edx;
+	unsigned int family;
+
+	if (!__get_cpuid(0, &eax, &ebx, &ecx, &edx)) {
+		return false;
+	}
+	if (ebx == signature_INTEL_ebx && ecx == signature_INTEL_ecx &&
+	    edx == signature_INTEL_edx) {
+		return true;
+	}
+	if (ebx != signature_AMD_ebx || ecx != signature_AMD_ecx ||
+	    edx != signature_AMD_edx) {
+		return false;
+	}
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		return false;
+	}
+
+	family = (eax >> 8) & 0x0F;
+	if (family == 0x0F) {
+		family += (eax >> 20) & 0xFF;
+	}
+	return family >= 0x19;
+}
+
+/*
+ * Spreads a 40-bit group into eight bytes of 5 bits each, the most
+ * significant 5 bits going to the last byte.
+ */
+static inline uint64 ulid_spread40(uint64 group) {
+	uint64 x = (group & UINT64CONST(0xFFFFF)) | ((group >> 20) << 32);
+
+	x = (x & UINT64CONST(0x000003FF000003FF)) |
+	    ((x & UINT64CONST(0x000FFC00000FFC00)) << 6);
+	x = (x & UINT64CONST(0x001F001F001F001F)) |
+	    ((x & UINT64CONST(0x03E003E003E003E0)) << 3);
+
+	return x;
+}
+
+/*
+ * Maps 16 lanes of 5-bit values to the Crockford base32 alphabet with two
+ * pshufb lookups, one per half of the alphabet.
+ */
+__attribute__((target("ssse3"))) static inline __m128i
+ulid_ssse3_alphabet(__m128i values) {
+	const __m128i low = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+	                                  '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+	const __m128i high = _mm_setr_epi8('G', 'H', 'J', 'K', 'M', 'N', 'P', 'Q',
+	                                   'R', 'S', 'T', 'V', 'W', 'X', 'Y', 'Z');
+	__m128i upper = _mm_cmpgt_epi8(values, _mm_set1_epi8(15));
+
+	return _mm_or_si128(
+		_mm_andnot_si128(upper, _mm_shuffle_epi8(low, values)),
+		_mm_and_si128(upper, _mm_shuffle_epi8(high, values)));
+}
+
+/*
+ * Writes characters 2-25 from three groups of eight 5-bit values, each given
+ * in string order as the bytes of a 64-bit word.  The two 16-byte stores at
+ * offsets 2 and 10 overlap, mirroring the loads of ulid_decode_ssse3().
+ */
+__attribute__((target("ssse3"))) static inline void
+ulid_ssse3_store(char *dst, uint64 group1, uint64 group2, uint64 group3) {
+	_mm_storeu_si128((__m128i *)(dst + 2),
+	                 ulid_ssse3_alphabet(_mm_set_epi64x((int64)group2,
+	                                                    (int64)group1)));
+	_mm_storeu_si128((__m128i *)(dst + 10),
+	                 ulid_ssse3_alphabet(_mm_set_epi64x((int64)group3,
+	                                                    (int64)group2)));
+}
+
+/*
+ * SSSE3 encoder.  The ULID is read as two 64-bit words; characters 0-1 come
+ * from the top byte, and the three 40-bit groups behind it are spread into
+ * 5-bit lanes with shifts and masks.
+ */
+__attribute__((target("ssse3"))) static void
+ulid_encode_ssse3(const pg_ulid_t *ulid, char *dst) {
+	uint64 top, bottom;
+
+	memcpy(&top, &ulid->data[0], sizeof(uint64));
+	memcpy(&bottom, &ulid->data[8], sizeof(uint64));
+	top = pg_ntoh64(top);
+	bottom = pg_ntoh64(bottom);
+
+	dst[0] = C32_ENCODING[ulid->data[0] >> 5];
+	dst[1] = C32_ENCODING[ulid->data[0] & 31];
+	ulid_ssse3_store(
+		dst, pg_hton64(ulid_spread40((top >> 16) & UINT64CONST(0xFFFFFFFFFF))),
+		pg_hton64(ulid_spread40(((top & 0xFFFF) << 24) | (bottom >> 40))),
+		pg_hton64(ulid_spread40(bottom & UINT64CONST(0xFFFFFFFFFF))));
+	dst[26] = '\0';
+}
+
+/*
+ * SSSE3 encoder that spreads each 40-bit group with a single BMI2 PDEP
+ * instead of shifts and masks.
+ */
+__attribute__((target("ssse3,bmi2"))) static void
+ulid_encode_bmi2(const pg_ulid_t *ulid, char *dst) {
+	const uint64 lanes = UINT64CONST(0x1F1F1F1F1F1F1F1F);
+	uint64 top, bottom;
+
+	memcpy(&top, &ulid->data[0], sizeof(uint64));
+	memcpy(&bottom, &ulid->data[8], sizeof(uint64));
+	top = pg_ntoh64(top);
+	bottom = pg_ntoh64(bottom);
+
+	dst[0] = C32_ENCODING[ulid->data[0] >> 5];
+	dst[1] = C32_ENCODING[ulid->data[0] & 31];
+	ulid_ssse3_store(
+		dst, pg_hton64(_pdep_u64(top >> 16, lanes)),
+		pg_hton64(_pdep_u64(((top & 0xFFFF) << 24) | (bottom >> 40), lanes)),
+		pg_hton64(_pdep_u64(bottom, lanes)));
+	dst[26] = '\0';
+}
+#endif
+
+/*
+ * Reports why the len bytes at source are not a valid ULID.  Only reached
+ * once the decoder has rejected the input, so the extra passes over the
+ * string cost nothing on the common path; the checks run in the same order
+ * as the documented rules.
+ */
+static void ulid_input_error(const char *source, size_t len,
+                             struct Node *escontext) {
+	const unsigned char *src = (const unsigned char *)source;
+
+	if (len != ULID_ENCODED_LEN) {
+		ereturn(escontext, ,
+		        errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+		        errmsg("invalid ulid: incorrect length %d (expected %d)",
+		               (int)len, ULID_ENCODED_LEN));
+	}
+
+	for (int i = 0; i < ULID_ENCODED_LEN; i++) {
+		if (DEC[src[i]] == 0xFF) {
+			ereturn(escontext, ,
+			        errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+			        errmsg("invalid ulid: bad character at position %d", i));
+		}
+	}
+
+	ereturn(escontext, ,
+	        errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+	        errmsg("invalid ulid: value overflows 128 bit encoding"));
+}
+
+/*
+ * Decodes 26 Crockford base32 characters in a single pass, returning false
+ * if any of them is invalid or the value overflows 128 bits.  Each character
+ * is looked up once and shifted straight into the 64-bit word it belongs to;
+ * DEC[] maps the NUL terminator to 0xFF like any other invalid byte, so one
+ * test per character also stops at the end of a short C string without
+ * reading past it.
+ *
+ * Of the 130-bit encoding, character 0 holds the top 5 bits, characters 1-12
+ * the next 60, character 13 straddles the two output words and characters
+ * 14-25 hold the low 60 bits.
+ */
+static inline bool ulid_decode_scalar(const unsigned char *src,
+                                      pg_ulid_t *ulid) {
+	uint64 first;
+	uint64 high = 0;
+	uint64 low = 0;
+	uint64 middle;
+	uint64 top, bottom;
+
+	first = DEC[src[0]];
+	if (unlikely(first == 0xFF)) {
+		return false;
+	}
+
+	for (int i = 1; i < 13; i++) {
+		uint8 value = DEC[src[i]];
+
+		if (unlikely(value == 0xFF)) {
+			return false;
+		}
+		high = (high << 5) | value;
+	}
+
+	middle = DEC[src[13]];
+	if (unlikely(middle == 0xFF)) {
+		return false;
+	}
+
+	for (int i = 14; i < ULID_ENCODED_LEN; i++) {
+		uint8 value = DEC[src[i]];
+
+		if (unlikely(value == 0xFF)) {
+			return false;
+		}
+		low = (low << 5) | value;
+	}
+
+	/* First character must be <= '7' to prevent 128-bit overflow */
+	if (unlikely(first > 7)) {
+		return false;
+	}
+
+	top = pg_hton64((first << 61) | (high << 1) | (middle >> 4));
+	bottom = pg_hton64((middle << 60) | low);
+	memcpy(&ulid->data[0], &top, sizeof(uint64));
+	memcpy(&ulid->data[8], &bottom, sizeof(uint64));
+
+	return true;
+}
+
+/*
+ * Decodes exactly ULID_ENCODED_LEN readable characters, using the vectorized
+ * decoder when available and enabled.
+ */
+static inline bool ulid_decode(const unsigned char *src, pg_ulid_t *ulid) {
+	if (ulid_fast_codec && ulid_decode_fast != NULL &&
+	    ulid_decode_fast(src, ulid)) {
+		return true;
+	}
+	return ulid_decode_scalar(src, ulid);
+}
+
+/*
+ * Decodes a NUL-terminated string.  The SIMD decoder loads all 26 characters
+ * at once, so it needs the length up front; strnlen() never looks further
+ * than one byte past a valid ULID.  The scalar decoder finds a short string
+ * by itself, and the byte at position 26 is read only once all 26 characters
+ * have been accepted.
+ */
+static void string_to_ulid(const char *source, pg_ulid_t *ulid,
+                           struct Node *escontext) {
+	const unsigned char *src = (const unsigned char *)source;
+
+	if (ulid_fast_codec && ulid_decode_fast != NULL &&
+	    strnlen(source, ULID_ENCODED_LEN + 1) == ULID_ENCODED_LEN &&
+	    ulid_decode_fast(src, ulid)) {
+		return;
+	}
+
+	if (unlikely(!ulid_decode_scalar(src, ulid) ||
+	             src[ULID_ENCODED_LEN] != '\0')) {
+		ulid_input_error(source, strlen(source), escontext);
+	}
+}
+
+/*
+ * Returns the current wall-clock time in milliseconds since the Unix epoch,
+ * read from the clock selected by ulid.clock_source.
+ */
+static uint64 ulid_current_ms(void) {
+	struct timespec ts;
+
+#ifdef CLOCK_REALTIME_COARSE
+	if (ulid_clock_source_guc == ULID_CLOCK_REALTIME_COARSE) {
+		if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) != 0) {
+			ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+			                errmsg("could not get CLOCK_REALTIME_COARSE")));
+		}
+
+		return ((uint64)ts.tv_sec * 1000) + ((uint64)ts.tv_nsec / 1000000);
+	}
+#endif
+
+	if (clock_gettime(CLOCK_REALTIME, &ts) != 0) {
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+		                errmsg("could not get CLOCK_REALTIME")));
+	}
+
+	return ((uint64)ts.tv_sec * 1000) + ((uint64)ts.tv_nsec / 1000000);
+}
+
+/*
+ * Converts a timestamptz to milliseconds since the Unix epoch, rounding down
+ * to the millisecond.  Raises an error if the result cannot be stored in the
+ * 48-bit timestamp of a ULID.
+ */
+static uint64 ulid_timestamptz_to_ms(TimestampTz ts) {
+	const int64 epoch_offset =
+		(int64)(POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * USECS_PER_DAY;
+
+	if (TIMESTAMP_NOT_FINITE(ts) || ts < -epoch_offset ||
+	    ts - ((int64)ULID_MAX_TIMESTAMP_MS * 1000 + 999) > -epoch_offset) {
+		ereport(ERROR, (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+		                errmsg("timestamp out of range for ulid")));
+	}
+
+	return (uint64)(ts + epoch_offset) / 1000;
+}
+
+/*
+ * Converts milliseconds since the Unix epoch to a timestamptz.  Every 48-bit
+ * value is within the range of timestamptz.
+ */
+static TimestampTz ulid_ms_to_timestamptz(uint64 ms) {
+	const int64 epoch_offset =
+		(int64)(POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * USECS_PER_DAY;
+
+	return (TimestampTz)(ms * 1000) - epoch_offset;
+}
+
+/*
+ * Fills buf with len bytes directly from pg_strong_random().
+ */
+static void ulid_strong_random(unsigned char *buf, size_t len) {
+	if (!pg_strong_random(buf, len)) {
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR),
+		                errmsg("could not generate random values")));
+	}
+}
+
+#define ULID_CHACHA_ROTL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+#define ULID_CHACHA_QR(a, b, c, d)                                            \
+	do {                                                                       \
+		(a) += (b);                                                            \
+		(d) = ULID_CHACHA_ROTL((d) ^ (a), 16);                                 \
+		(c) += (d);                                                            \
+		(b) = ULID_CHACHA_ROTL((b) ^ (c), 12);                                 \
+		(a) += (b);                                                            \
+		(d) = ULID_CHACHA_ROTL((d) ^ (a), 8);                                  \
+		(c) += (d);                                                            \
+		(b) = ULID_CHACHA_ROTL((b) ^ (c), 7);                                  \
+	} while (0)
+
+static inline uint32 ulid_load32_le(const unsigned char *p) {
+	return (uint32)p[0] | ((uint32)p[1] << 8) | ((uint32)p[2] << 16) |
+	       ((uint32)p[3] << 24);
+}
+
+/*
+ * Computes one 64-byte ChaCha20 keystream block for the given input state.
+ */
+static void ulid_chacha_block(const uint32 input[16],
+                              unsigned char out[ULID_CHACHA_BLOCK_LEN]) {
+	uint32 x[16];
+
+	memcpy(x, input, sizeof(x));
+
+	for (int i = 0; i < 10; i++) {
+		/* column round */
+		ULID_CHACHA_QR(x[0], x[4], x[8], x[12]);
+		ULID_CHACHA_QR(x[1], x[5], x[9], x[13]);
+		ULID_CHACHA_QR(x[2], x[6], x[10], x[14]);
+		ULID_CHACHA_QR(x[3], x[7], x[11], x[15]);
+		/* diagonal round */
+		ULID_CHACHA_QR(x[0], x[5], x[10], x[15]);
+		ULID_CHACHA_QR(x[1], x[6], x[11], x[12]);
+		ULID_CHACHA_QR(x[2], x[7], x[8], x[13]);
+		ULID_CHACHA_QR(x[3], x[4], x[9], x[14]);
+	}
+
+	for (int i = 0; i < 16; i++) {
+		uint32 v = x[i] + input[i];
+
+		out[(i * 4) + 0] = (unsigned char)v;
+		out[(i * 4) + 1] = (unsigned char)(v >> 8);
+		out[(i * 4) + 2] = (unsigned char)(v >> 16);
+		out[(i * 4) + 3] = (unsigned char)(v >> 24);
+	}
+
+	memset(x, 0, sizeof(x));
+}
+
+/*
+ * Loads a 32-byte key and 12-byte nonce into the ChaCha20 state and resets
+ * the block counter.
+ */
+static void ulid_chacha_keysetup(ulid_chacha_state *st,
+                                 const unsigned char *seed) {
+	/* "expand 32-byte k" */
+	st->input[0] = 0x61707865;
+	st->input[1] = 0x3320646e;
+	st->input[2] = 0x79622d32;
+	st->input[3] = 0x6b206574;
+	for (int i = 0; i < 8; i++) {
+		st->input[4 + i] = ulid_load32_le(seed + (i * 4));
+	}
+	st->input[12] = 0;
+	for (int i = 0; i < 3; i++) {
+		st->input[13 + i] = ulid_load32_le(seed + ULID_CHACHA_KEY_LEN + (i * 4));
+	}
+}
+
+/*
+ * Fills buf with len bytes of ChaCha20 keystream, seeding or reseeding the
+ * generator from pg_strong_random() first when needed.
+ */
+static void ulid_chacha_random(unsigned char *buf, size_t len) {
+	unsigned char block[ULID_CHACHA_BLOCK_LEN];
+
+	if (chacha_state.pid != MyProcPid ||
+	    chacha_state.generated >= ULID_CHACHA_RESEED_BYTES) {
+		unsigned char seed[ULID_CHACHA_SEED_LEN];
+
+		ulid_strong_random(seed, ULID_CHACHA_SEED_LEN);
+		ulid_chacha_keysetup(&chacha_state, seed);
+		memset(seed, 0, sizeof(seed));
+		chacha_state.generated = 0;
+		chacha_state.pid = MyProcPid;
+	}
+
+	chacha_state.generated += len;
+
+	while (len > 0) {
+		size_t n = Min(len, ULID_CHACHA_BLOCK_LEN);
+
+		ulid_chacha_block(chacha_state.input, block);
+		chacha_state.input[12]++;
+		memcpy(buf, block, n);
+		buf += n;
+		len -= n;
+	}
+
+	/* Fast key erasure: rekey from the next block */
+	ulid_chacha_block(chacha_state.input, block);
+	ulid_chacha_keysetup(&chacha_state, block);
+	memset(block, 0, sizeof(block));
+}
+
+/*
+ * Fills buf with len random bytes from the source selected by
+ * ulid.random_source.
+ */
+static void ulid_random_bytes(unsigned char *buf, size_t len) {
+	if (ulid_random_source_guc == ULID_RANDOM_CHACHA) {
+		ulid_chacha_random(buf, len);
+	} else {
+		ulid_strong_random(buf, len);
+	}
+}
+
+/*
+ * Discards the entropy pool, so that the next ULID draws from the newly
+ * selected random source.
+ */
+static void ulid_random_source_assign(int newval, void *extra) {
+	if (entropy_pool != NULL) {
+		memset(entropy_pool, 0, entropy_pool_alloc);
+	}
+	entropy_pool_len = 0;
+	entropy_pool_pos = 0;
+}
+
+/*
+ * GUC assign hook for ulid.node_id and ulid.node_bits: restart the node
+ * counter, so that it is never continued under a different layout.
+ */
+static void ulid_node_assign(int newval, void *extra) {
+	node_state.valid = false;
+}
+
+/*
+ * Refills the entropy pool, (re)allocating it if ulid.entropy_pool_size has
+ * changed since the last refill.
+ */
+static void ulid_refill_entropy_pool(void) {
+	if (entropy_pool_alloc != ulid_entropy_pool_size) {
+		if (entropy_pool != NULL) {
+			memset(entropy_pool, 0, entropy_pool_alloc);
+			pfree(entropy_pool);
+			entropy_pool = NULL;
+			entropy_pool_alloc = 0;
+		}
+		entropy_pool =
+			MemoryContextAlloc(TopMemoryContext, ulid_entropy_pool_size);
+		entropy_pool_alloc = ulid_entropy_pool_size;
+	}
+
+	entropy_pool_len = 0;
+	entropy_pool_pos = 0;
+	ulid_random_bytes(entropy_pool, entropy_pool_alloc);
+	entropy_pool_len = entropy_pool_alloc;
+	entropy_pool_pid = MyProcPid;
+}
+
+/*
+ * Fills buf with len bytes of cryptographically secure randomness, served
+ * from the per-backend entropy pool when it is enabled.  The pool is filled
+ * from the source selected by ulid.random_source.
+ */
+static void ulid_fill_random(unsigned char *buf, size_t len) {
+	if (len > (size_t)ulid_entropy_pool_size) {
+		ulid_random_bytes(buf, len);
+		return;
+	}
+
+	/* Never hand out bytes inherited from a parent process */
+	if (entropy_pool_pid != MyProcPid) {
+		if (entropy_pool != NULL) {
+			memset(entropy_pool, 0, entropy_pool_alloc);
+		}
+		entropy_pool_len = 0;
+		entropy_pool_pos = 0;
+	}
+
+	if ((size_t)(entropy_pool_len - entropy_pool_pos) < len) {
+		ulid_refill_entropy_pool();
+	}
+
+	memcpy(buf, entropy_pool + entropy_pool_pos, len);
+	memset(entropy_pool + entropy_pool_pos, 0, len);
+	entropy_pool_pos += (int)len;
+}
+
+/*
+ * Produces the next ULID of a monotonic sequence.
+ *
+ * If ms is later than the last timestamp issued from this state, a fresh
+ * random component is drawn.  Otherwise (same millisecond, or the clock
+ * stepped backwards) the previous timestamp is kept and the 80-bit random
+ * component is incremented by one, as described in the ULID specification.
+ * Every ULID produced from one state therefore sorts after the previous one.
+ *
+ * If the random component would overflow, an error is raised and the state
+ * is left unchanged, so generation resumes once the clock moves past the
+ * exhausted millisecond.
+ */
+static void ulid_monotonic_next(ulid_monotonic_state *state, uint64 ms,
+                                pg_ulid_t *ulid) {
+	if (state->valid && ms <= state->last_ms) {
+		if (state->rand_lo == PG_UINT64_MAX &&
+		    state->rand_hi == PG_UINT16_MAX) {
+			ereport(ERROR,
+			        (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+			         errmsg("could not generate monotonic ulid: random "
+			                "component overflow in millisecond " UINT64_FORMAT,
+			                state->last_ms)));
+		}
+
+		if (++state->rand_lo == 0) {
+			state->rand_hi++;
+		}
+	} else {
+		unsigned char rnd[ULID_RANDOM_LEN];
+
+		ulid_fill_random(rnd, ULID_RANDOM_LEN);
+		state->rand_hi = (uint16)((rnd[0] << 8) | rnd[1]);
+		memcpy(&state->rand_lo, &rnd[2], sizeof(uint64));
+		state->rand_lo = pg_ntoh64(state->rand_lo);
+		state->last_ms = ms;
+		state->valid = true;
+	}
+
+	ulid_set_timestamp(ulid, state->last_ms);
+	ulid_set_random(ulid, state->rand_hi, state->rand_lo);
+}
+
+PG_FUNCTION_INFO_V1(gen_random_ulid);
+Datum gen_random_ulid(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid = palloc(ULID_LEN);
+
+	ulid_set_timestamp(ulid, ulid_current_ms());
+	ulid_fill_random(&ulid->data[ULID_TIMESTAMP_LEN], ULID_RANDOM_LEN);
+
+	PG_RETURN_ULID_P(ulid);
+}
+
+/*
+ * Generates a ULID that sorts strictly after every ULID previously returned
+ * by this function in the same backend.
+ */
+PG_FUNCTION_INFO_V1(gen_monotonic_ulid);
+Datum gen_monotonic_ulid(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid = palloc(ULID_LEN);
+
+	ulid_monotonic_next(&monotonic_state, ulid_current_ms(), ulid);
+
+	PG_RETURN_ULID_P(ulid);
+}
+
+/*
+ * Generates a ULID whose timestamp is the start time of the current
+ * statement.  Within a statement the random component is incremented, so all
+ * ULIDs of one statement form a single sorted run.
+ */
+PG_FUNCTION_INFO_V1(gen_statement_ulid);
+Datum gen_statement_ulid(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid = palloc(ULID_LEN);
+
+	ulid_monotonic_next(
+		&statement_state,
+		ulid_timestamptz_to_ms(GetCurrentStatementStartTimestamp()), ulid);
+
+	PG_RETURN_ULID_P(ulid);
+}
+
+/*
+ * Generates a ULID whose 16 bytes are also a valid UUIDv7: the version and
+ * variant fields are set in place, leaving 74 random bits.  Casting the
+ * result to uuid needs no conversion.
+ */
+PG_FUNCTION_INFO_V1(gen_random_ulid_v7compat);
+Datum gen_random_ulid_v7compat(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid = palloc(ULID_LEN);
+
+	ulid_set_timestamp(ulid, ulid_current_ms());
+	ulid_fill_random(&ulid->data[ULID_TIMESTAMP_LEN], ULID_RANDOM_LEN);
+	ulid->data[6] = 0x70 | (ulid->data[6] & 0x0F);
+	ulid->data[8] = 0x80 | (ulid->data[8] & 0x3F);
+
+	PG_RETURN_ULID_P(ulid);
+}
+
+/*
+ * Generates a ULID with the given timestamp, truncated to the millisecond,
+ * and a random component.
+ */
+PG_FUNCTION_INFO_V1(gen_ulid_at);
+Datum gen_ulid_at(PG_FUNCTION_ARGS) {
+	uint64 ms = ulid_timestamptz_to_ms(PG_GETARG_TIMESTAMPTZ(0));
+	pg_ulid_t *ulid = palloc(ULID_LEN);
+
+	ulid_set_timestamp(ulid, ms);
+	ulid_fill_random(&ulid->data[ULID_TIMESTAMP_LEN], ULID_RANDOM_LEN);
+
+	PG_RETURN_ULID_P(ulid);
+}
+
+/*
+ * Generates a ULID with the given timestamp that sorts after the previous
+ * ULID from this function if both fall into the same millisecond.
+ *
+ * Unlike gen_monotonic_ulid(), the state is keyed on the supplied
+ * millisecond: any other millisecond, earlier or later, starts with fresh
+ * randomness instead of continuing the last one, so the timestamp of every
+ * ULID is exactly the one supplied.
+ */
+PG_FUNCTION_INFO_V1(gen_monotonic_ulid_at);
+Datum gen_monotonic_ulid_at(PG_FUNCTION_ARGS) {
+	uint64 ms = ulid_timestamptz_to_ms(PG_GETARG_TIMESTAMPTZ(0));
+	pg_ulid_t *ulid = palloc(ULID_LEN);
+
+	if (ms != keyed_state.last_ms) {
+		keyed_state.valid = false;
+	}
+	ulid_monotonic_next(&keyed_state, ms, ulid);
+
+	PG_RETURN_ULID_P(ulid);
+}
+
+/*
+ * Validates the requested size of a batch of ULIDs.
+ */
+static void ulid_check_batch_count(int32 count) {
+	if (count < 0) {
+		ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+		                errmsg("count must not be negative")));
+	}
+}
+
+/*
+ * Set-returning function generating a batch of ULIDs.
+ *
+ * The clock is read once for the whole batch, and the ULIDs are drawn from
+ * the monotonic sequence of gen_monotonic_ulid(): the first ULID gets a fresh
+ * random component (unless the sequence is already at or past the batch
+ * timestamp) and the rest increment it, so the batch comes out sorted and
+ * needs random bytes only once.
+ */
+PG_FUNCTION_INFO_V1(gen_random_ulids);
+Datum gen_random_ulids(PG_FUNCTION_ARGS) {
+	FuncCallContext *funcctx;
+	uint64 *batch_ms;
+
+	if (SRF_IS_FIRSTCALL()) {
+		int32 count = PG_GETARG_INT32(0);
+		MemoryContext oldcontext;
+
+		ulid_check_batch_count(count);
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		batch_ms = palloc(sizeof(uint64));
+		*batch_ms = ulid_current_ms();
+		funcctx->user_fctx = batch_ms;
+		funcctx->max_calls = count;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	batch_ms = funcctx->user_fctx;
+
+	if (funcctx->call_cntr < funcctx->max_calls) {
+		pg_ulid_t *ulid = palloc(ULID_LEN);
+
+		ulid_monotonic_next(&monotonic_state, *batch_ms, ulid);
+		SRF_RETURN_NEXT(funcctx, ULIDPGetDatum(ulid));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+/*
+ * Array variant of gen_random_ulids().  The ULIDs are written directly into
+ * a single allocation holding the result array.
+ */
+PG_FUNCTION_INFO_V1(gen_random_ulid_array);
+Datum gen_random_ulid_array(PG_FUNCTION_ARGS) {
+	int32 count = PG_GETARG_INT32(0);
+	Oid elemtype = get_element_type(get_fn_expr_rettype(fcinfo->flinfo));
+	ArrayType *result;
+	pg_ulid_t *ulids;
+	Size nbytes;
+	uint64 ms;
+
+	ulid_check_batch_count(count);
+
+	if (count == 0) {
+		PG_RETURN_ARRAYTYPE_P(construct_empty_array(elemtype));
+	}
+
+	nbytes = ulid_array_alloc_size(ARR_OVERHEAD_NONULLS(1), count, ULID_LEN);
+	result = (ArrayType *)palloc0(nbytes);
+	SET_VARSIZE(result, nbytes);
+	result->ndim = 1;
+	result->dataoffset = 0;
+	result->elemtype = elemtype;
+	ARR_DIMS(result)[0] = count;
+	ARR_LBOUND(result)[0] = 1;
+
+	ulids = (pg_ulid_t *)ARR_DATA_PTR(result);
+	ms = ulid_current_ms();
+	for (int32 i = 0; i < count; i++) {
+		ulid_monotonic_next(&monotonic_state, ms, &ulids[i]);
+	}
+
+	PG_RETURN_ARRAYTYPE_P(result);
+}
+
+/*
+ * Raises an error unless the shared generator state is available.
+ */
+static void ulid_check_shared_state(void) {
+	if (shared_state == NULL) {
+		ereport(ERROR,
+		        (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+		         errmsg("the shared ulid generator is not available"),
+		         errhint("Add \"ulid\" to shared_preload_libraries and "
+		                 "restart the server.")));
+	}
+}
+
+/*
+ * Advances the 64-bit (timestamp, sequence) word at clock and returns its new
+ * value, which no other call on the same word returns.
+ *
+ * The word is advanced with a compare-and-swap loop: to the current
+ * millisecond with sequence zero if the clock has moved past it, otherwise by
+ * one.  A sequence overflow carries into the timestamp, borrowing the next
+ * millisecond.  Retries are counted and reported as a wait event while they
+ * last.
+ */
+static uint64 ulid_shared_advance(pg_atomic_uint64 *clock) {
+	uint64 now;
+	uint64 old_clock;
+	uint64 new_clock;
+	uint64 retries = 0;
+
+#if PG_VERSION_NUM >= 170000
+	if (shared_wait_event_info == 0) {
+		shared_wait_event_info = WaitEventExtensionNew("UlidSharedGenerator");
+	}
+#else
+	shared_wait_event_info = PG_WAIT_EXTENSION;
+#endif
+
+	now = ulid_current_ms() << 16;
+
+	old_clock = pg_atomic_read_u64(clock);
+	for (;;) {
+		new_clock = (now > old_clock) ? now : old_clock + 1;
+
+		if (pg_atomic_compare_exchange_u64(clock, &old_clock, new_clock)) {
+			break;
+		}
+
+		if (retries++ == 0) {
+			pgstat_report_wait_start(shared_wait_event_info);
+		}
+	}
+
+	if (retries > 0) {
+		pgstat_report_wait_end();
+		pg_atomic_fetch_add_u64(&shared_state->retries, retries);
+	}
+
+	return new_clock;
+}
+
+/*
+ * Generates a ULID that sorts strictly after every ULID previously returned
+ * by this function in any backend of the instance.  Its first 64 bits are the
+ * word advanced by ulid_shared_advance().
+ */
+PG_FUNCTION_INFO_V1(gen_shared_ulid);
+Datum gen_shared_ulid(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid;
+	uint64 clock;
+
+	ulid_check_shared_state();
+
+	ulid = palloc(ULID_LEN);
+	clock = ulid_shared_advance(&shared_state->clock);
+
+	ulid_set_timestamp(ulid, clock >> 16);
+	ulid->data[6] = (unsigned char)(clock >> 8);
+	ulid->data[7] = (unsigned char)clock;
+	ulid_fill_random(&ulid->data[8], ULID_LEN - 8);
+
+	PG_RETURN_ULID_P(ulid);
+}
+
+/*
+ * Returns the number of compare-and-swap retries of gen_shared_ulid() and
+ * gen_node_ulid() since server start, as a measure of contention.
+ */
+PG_FUNCTION_INFO_V1(ulid_shared_retries);
+Datum ulid_shared_retries(PG_FUNCTION_ARGS) {
+	ulid_check_shared_state();
+
+	PG_RETURN_INT64((int64)pg_atomic_read_u64(&shared_state->retries));
+}
+
+/*
+ * Advances the node counter in state and assembles a ULID carrying node_id in
+ * the high node_bits bits of the random component.
+ *
+ * The counter fills the remaining (80 - node_bits) bits.  In a new
+ * millisecond it starts at a random value, which needs fewer random bytes the
+ * more bits the node identifier takes; within a millisecond it is incremented
+ * as in ulid_monotonic_next().
+ */
+static void ulid_node_next(ulid_monotonic_state *state, uint64 ms,
+                           uint32 node_id, int node_bits, pg_ulid_t *ulid) {
+	int counter_bits = ULID_RANDOM_LEN * 8 - node_bits;
+	uint64 lo_mask;
+	uint16 hi_mask;
+	uint64 rand_lo;
+	uint16 rand_hi;
+
+	lo_mask = counter_bits >= 64 ? PG_UINT64_MAX
+	                             : (UINT64CONST(1) << counter_bits) - 1;
+	hi_mask = counter_bits > 64 ? (uint16)((1 << (counter_bits - 64)) - 1) : 0;
+
+	if (state->valid && ms <= state->last_ms) {
+		if (state->rand_lo == lo_mask && state->rand_hi == hi_mask) {
+			ereport(ERROR,
+			        (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+			         errmsg("could not generate node ulid: counter overflow "
+			                "in millisecond " UINT64_FORMAT,
+			                state->last_ms)));
+		}
+
+		if (++state->rand_lo == 0) {
+			state->rand_hi++;
+		}
+	} else {
+		unsigned char rnd[ULID_RANDOM_LEN] = {0};
+		int nbytes = (counter_bits + 7) / 8;
+
+		ulid_fill_random(&rnd[ULID_RANDOM_LEN - nbytes], nbytes);
+		state->rand_hi = (uint16)((rnd[0] << 8) | rnd[1]) & hi_mask;
+		memcpy(&state->rand_lo, &rnd[2], sizeof(uint64));
+		state->rand_lo = pg_ntoh64(state->rand_lo) & lo_mask;
+		state->last_ms = ms;
+		state->valid = true;
+	}
+
+	rand_hi = state->rand_hi;
+	rand_lo = state->rand_lo;
+	if (counter_bits >= 64) {
+		rand_hi |= (uint16)(node_id << (counter_bits - 64));
+	} else {
+		rand_lo |= (uint64)node_id << counter_bits;
+		rand_hi |= (uint16)(node_id >> (64 - counter_bits));
+	}
+
+	ulid_set_timestamp(ulid, state->last_ms);
+	ulid_set_random(ulid, rand_hi, rand_lo);
+}
+
+/*
+ * Assembles a ULID carrying node_id in the high node_bits bits of the random
+ * component from the instance-wide node clock.
+ *
+ * The timestamp and a 16-bit sequence come from ulid_shared_advance(), so no
+ * two backends of the instance get the same pair; the sequence follows the
+ * node identifier and the remaining (64 - node_bits) bits are random.
+ */
+static void ulid_node_shared_next(uint32 node_id, int node_bits,
+                                  pg_ulid_t *ulid) {
+	int counter_bits = ULID_RANDOM_LEN * 8 - node_bits;
+	int random_bits = counter_bits - 16;
+	uint64 clock = ulid_shared_advance(&shared_state->node_clock);
+	uint64 seq = clock & 0xFFFF;
+	uint64 rand_lo;
+	uint16 rand_hi = 0;
+
+	ulid_fill_random((unsigned char *)&rand_lo, sizeof(rand_lo));
+	rand_lo &= (UINT64CONST(1) << random_bits) - 1;
+
+	rand_lo |= seq << random_bits;
+	if (counter_bits > 64) {
+		rand_hi |= (uint16)(seq >> (64 - random_bits));
+	}
+	if (counter_bits >= 64) {
+		rand_hi |= (uint16)(node_id << (counter_bits - 64));
+	} else {
+		rand_lo |= (uint64)node_id << counter_bits;
+		rand_hi |= (uint16)(node_id >> (64 - counter_bits));
+	}
+
+	ulid_set_timestamp(ulid, clock >> 16);
+	ulid_set_random(ulid, rand_hi, rand_lo);
+}
+
+/*
+ * Extracts the node identifier from the high node_bits bits of the random
+ * component.
+ */
+static int32 ulid_extract_node_id(const pg_ulid_t *ulid, int node_bits) {
+	uint64 head = 0;
+
+	if (node_bits < 1 || node_bits > ULID_NODE_BITS_MAX) {
+		ereport(ERROR,
+		        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+		         errmsg("node_bits must be between 1 and %d",
+		                ULID_NODE_BITS_MAX)));
+	}
+
+	/* Bytes 6-10 hold the first 40 bits of the random component */
+	for (int i = ULID_TIMESTAMP_LEN; i < ULID_TIMESTAMP_LEN + 5; i++) {
+		head = (head << 8) | ulid->data[i];
+	}
+
+	return (int32)(head >> (40 - node_bits));
+}
+
+/*
+ * Generates a ULID embedding ulid.node_id, so that ULIDs minted on different
+ * nodes never collide and the issuing node can be read back from the ULID.
+ * ULIDs of one backend are strictly increasing.
+ *
+ * When the library is preloaded, the counter below the node identifier comes
+ * from shared memory, so backends of one node cannot collide either.
+ * Otherwise each backend keeps its own counter starting at a random value.
+ */
+PG_FUNCTION_INFO_V1(gen_node_ulid);
+Datum gen_node_ulid(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid;
+
+	if (ulid_node_id < 0) {
+		ereport(ERROR,
+		        (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+		         errmsg("ulid.node_id is not set"),
+		         errhint("Set ulid.node_id to the identifier of this node.")));
+	}
+	if (ulid_node_bits < 31 && ulid_node_id >= (1 << ulid_node_bits)) {
+		ereport(ERROR,
+		        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+		         errmsg("ulid.node_id %d does not fit in %d bits", ulid_node_id,
+		                ulid_node_bits),
+		         errhint("Increase ulid.node_bits.")));
+	}
+
+	ulid = palloc(ULID_LEN);
+	if (shared_state != NULL) {
+		ulid_node_shared_next((uint32)ulid_node_id, ulid_node_bits, ulid);
+	} else {
+		ulid_node_next(&node_state, ulid_current_ms(), (uint32)ulid_node_id,
+		               ulid_node_bits, ulid);
+	}
+
+	PG_RETURN_ULID_P(ulid);
+}
+
+/*
+ * Returns the node identifier stored in the high node_bits bits of a ULID's
+ * random component.
+ */
+PG_FUNCTION_INFO_V1(ulid_node_id_bits);
+Datum ulid_node_id_bits(PG_FUNCTION_ARGS) {
+	PG_RETURN_INT32(
+		ulid_extract_node_id(PG_GETARG_ULID_P(0), PG_GETARG_INT32(1)));
+}
+
+/*
+ * Returns the node identifier of a ULID using the current ulid.node_bits.
+ */
+PG_FUNCTION_INFO_V1(ulid_node_id_current);
+Datum ulid_node_id_current(PG_FUNCTION_ARGS) {
+	PG_RETURN_INT32(ulid_extract_node_id(PG_GETARG_ULID_P(0), ulid_node_bits));
+}
+
+/*
+ * Returns the smallest (upper = false) or largest (upper = true) ULID with
+ * the given millisecond timestamp.
+ */
+static pg_ulid_t *ulid_bound_at(uint64 ms, bool upper) {
+	pg_ulid_t *ulid = palloc(ULID_LEN);
+
+	ulid_set_timestamp(ulid, ms);
+	memset(&ulid->data[ULID_TIMESTAMP_LEN], upper ? 0xFF : 0x00,
+	       ULID_RANDOM_LEN);
+	return ulid;
+}
+
+/*
+ * Returns the timestamp embedded in a ULID.
+ */
+PG_FUNCTION_INFO_V1(ulid_timestamp);
+Datum ulid_timestamp(PG_FUNCTION_ARGS) {
+	PG_RETURN_TIMESTAMPTZ(
+		ulid_ms_to_timestamptz(ulid_get_timestamp(PG_GETARG_ULID_P(0))));
+}
+
+/*
+ * Returns the smallest ULID in the millisecond containing the given
+ * timestamp, for use as an inclusive lower bound of a time range.
+ */
+PG_FUNCTION_INFO_V1(ulid_min_at);
+Datum ulid_min_at(PG_FUNCTION_ARGS) {
+	PG_RETURN_ULID_P(
+		ulid_bound_at(ulid_timestamptz_to_ms(PG_GETARG_TIMESTAMPTZ(0)), false));
+}
+
+/*
+ * Returns the largest ULID in the millisecond containing the given
+ * timestamp, for use as an inclusive upper bound of a time range.
+ */
+PG_FUNCTION_INFO_V1(ulid_max_at);
+Datum ulid_max_at(PG_FUNCTION_ARGS) {
+	PG_RETURN_ULID_P(
+		ulid_bound_at(ulid_timestamptz_to_ms(PG_GETARG_TIMESTAMPTZ(0)), true));
+}
+
+/*
+ * True if the timestamp of a ULID lies between lower and upper, inclusive;
+ * the same as ulid_timestamp(id) BETWEEN lower AND upper.  Unlike that
+ * expression, a call can be turned into a range scan of a btree index on id
+ * by ulid_time_support().
+ */
+PG_FUNCTION_INFO_V1(ulid_time_between);
+Datum ulid_time_between(PG_FUNCTION_ARGS) {
+	TimestampTz ts =
+		ulid_ms_to_timestamptz(ulid_get_timestamp(PG_GETARG_ULID_P(0)));
+
+	PG_RETURN_BOOL(ts >= PG_GETARG_TIMESTAMPTZ(1) &&
+	               ts <= PG_GETARG_TIMESTAMPTZ(2));
+}
+
+/*
+ * Builds the ulid expression bounding one side of ulid_time_between().  A
+ * constant timestamp becomes a ulid constant; anything else becomes a call
+ * to ulid_min_at() or ulid_max_at() on the timestamp clamped to the range a
+ * ULID can hold, so that a bound outside it still gives a valid (if lossy)
+ * index condition instead of an error.  Returns NULL for a NULL constant.
+ */
+static Expr *ulid_time_bound(Oid funcid, Oid ulid_type, Expr *ts, bool upper) {
+	TimestampTz min_ts = ulid_ms_to_timestamptz(0);
+	TimestampTz max_ts = ulid_ms_to_timestamptz(ULID_MAX_TIMESTAMP_MS);
+	MinMaxExpr *greatest;
+	MinMaxExpr *least;
+	List *name;
+	Oid argtype = TIMESTAMPTZOID;
+
+	if (IsA(ts, Const)) {
+		Const *value = (Const *)ts;
+		TimestampTz clamped;
+
+		if (value->constisnull) {
+			return NULL;
+		}
+
+		clamped = DatumGetTimestampTz(value->constvalue);
+		clamped = Min(Max(clamped, min_ts), max_ts);
+		return (Expr *)makeConst(
+			ulid_type, -1, InvalidOid, ULID_LEN,
+			PointerGetDatum(
+				ulid_bound_at(ulid_timestamptz_to_ms(clamped), upper)),
+			false, false);
+	}
+
+	greatest = makeNode(MinMaxExpr);
+	greatest->minmaxtype = TIMESTAMPTZOID;
+	greatest->op = IS_GREATEST;
+	greatest->args = list_make2(
+		ts, makeConst(TIMESTAMPTZOID, -1, InvalidOid, sizeof(TimestampTz),
+	                  TimestampTzGetDatum(min_ts), false, FLOAT8PASSBYVAL));
+	greatest->location = -1;
+
+	least = makeNode(MinMaxExpr);
+	least->minmaxtype = TIMESTAMPTZOID;
+	least->op = IS_LEAST;
+	least->args = list_make2(
+		greatest, makeConst(TIMESTAMPTZOID, -1, InvalidOid, sizeof(TimestampTz),
+	                        TimestampTzGetDatum(max_ts), false, FLOAT8PASSBYVAL));
+	least->location = -1;
+
+	/* ulid_min_at() and ulid_max_at() live next to ulid_time_between() */
+	name = list_make2(makeString(get_namespace_name(get_func_namespace(funcid))),
+	                  makeString(upper ? "ulid_max_at" : "ulid_min_at"));
+	return (Expr *)makeFuncExpr(LookupFuncName(name, 1, &argtype, false),
+	                            ulid_type, list_make1(least), InvalidOid,
+	                            InvalidOid, COERCE_EXPLICIT_CALL);
+}
+
+/*
+ * Builds the btree conditions id >= lower bound AND id <= upper bound
+ * implied by a call of ulid_time_between() with the given arguments, using
+ * the operators of the given operator family.  Returns NIL if they cannot
+ * be built.
+ */
+static List *ulid_time_conditions(Oid funcid, Oid opfamily, List *args) {
+	Expr *id = (Expr *)linitial(args);
+	Oid ulid_type = exprType((Node *)id);
+	Oid ge_op = get_opfamily_member(opfamily, ulid_type, ulid_type,
+	                                BTGreaterEqualStrategyNumber);
+	Oid le_op = get_opfamily_member(opfamily, ulid_type, ulid_type,
+	                                BTLessEqualStrategyNumber);
+	Expr *lower;
+	Expr *upper;
+
+	if (!OidIsValid(ge_op) || !OidIsValid(le_op)) {
+		return NIL;
+	}
+
+	lower = ulid_time_bound(funcid, ulid_type, (Expr *)lsecond(args), false);
+	upper = ulid_time_bound(funcid, ulid_type, (Expr *)lthird(args), true);
+	if (lower == NULL || upper == NULL) {
+		return NIL;
+	}
+
+	return list_make2(make_opclause(ge_op, BOOLOID, false, id, lower,
+	                                InvalidOid, InvalidOid),
+	                  make_opclause(le_op, BOOLOID, false, id, upper,
+	                                InvalidOid, InvalidOid));
+}
+
+/*
+ * Planner support function for ulid_time_between().
+ *
+ * For SupportRequestIndexCondition, a call whose first argument is the key
+ * of a btree index on a ulid column is turned into the range conditions
+ * from ulid_time_conditions().  They are lossy because the bounds cover
+ * whole milliseconds, so the call itself is rechecked on every row.
+ *
+ * For SupportRequestSelectivity, the selectivity is estimated as that of
+ * the same range conditions taken as one range.
+ */
+PG_FUNCTION_INFO_V1(ulid_time_support);
+Datum ulid_time_support(PG_FUNCTION_ARGS) {
+	Node *rawreq = (Node *)PG_GETARG_POINTER(0);
+
+	if (IsA(rawreq, SupportRequestIndexCondition)) {
+		SupportRequestIndexCondition *req =
+			(SupportRequestIndexCondition *)rawreq;
+		FuncExpr *clause = (FuncExpr *)req->node;
+		List *conditions;
+
+		if (!is_funcclause(clause) || req->indexarg != 0 ||
+		    req->index->relam != BTREE_AM_OID ||
+		    !is_pseudo_constant_for_index(req->root, lsecond(clause->args),
+		                                  req->index) ||
+		    !is_pseudo_constant_for_index(req->root, lthird(clause->args),
+		                                  req->index)) {
+			PG_RETURN_POINTER(NULL);
+		}
+
+		conditions =
+			ulid_time_conditions(clause->funcid, req->opfamily, clause->args);
+		if (conditions != NIL) {
+			req->lossy = true;
+		}
+		PG_RETURN_POINTER(conditions);
+	}
+
+	if (IsA(rawreq, SupportRequestSelectivity)) {
+		SupportRequestSelectivity *req = (SupportRequestSelectivity *)rawreq;
+		Oid ulid_type = exprType(linitial(req->args));
+		Oid opclass = GetDefaultOpClass(ulid_type, BTREE_AM_OID);
+		List *conditions;
+		Selectivity selec;
+
+		if (req->is_join || !OidIsValid(opclass)) {
+			PG_RETURN_POINTER(NULL);
+		}
+
+		conditions = ulid_time_conditions(
+			req->funcid, get_opclass_family(opclass), req->args);
+		if (conditions == NIL) {
+			PG_RETURN_POINTER(NULL);
+		}
+
+		/*
+		 * Estimate both ends together, as clauselist_selectivity() does for
+		 * a pair of range conditions, correcting for NULLs being excluded
+		 * by both.  It cannot pair them itself because the operators do not
+		 * use the scalarltsel() family of estimators.
+		 */
+		selec = clause_selectivity(req->root, linitial(conditions),
+		                           req->varRelid, req->jointype, req->sjinfo) +
+		        clause_selectivity(req->root, lsecond(conditions),
+		                           req->varRelid, req->jointype, req->sjinfo) -
+		        1.0;
+		selec += nulltestsel(req->root, IS_NULL, linitial(req->args),
+		                     req->varRelid, req->jointype, req->sjinfo);
+		if (selec <= 0.0) {
+			selec = selec < -0.01 ? 1.0e-10 : DEFAULT_RANGE_INEQ_SEL;
+		}
+		CLAMP_PROBABILITY(selec);
+
+		req->selectivity = selec;
+		PG_RETURN_POINTER(req);
+	}
+
+	PG_RETURN_POINTER(NULL);
+}
+
+/* Binary input: the 16 bytes are copied straight from the message */
+PG_FUNCTION_INFO_V1(ulid_recv);
+Datum ulid_recv(PG_FUNCTION_ARGS) {
+	StringInfo buffer = (StringInfo)PG_GETARG_POINTER(0);
+	pg_ulid_t *ulid = (pg_ulid_t *)palloc(ULID_LEN);
+
+	pq_copymsgbytes(buffer, (char *)ulid->data, ULID_LEN);
+	PG_RETURN_POINTER(ulid);
+}
+
+/*
+ * Binary output. Builds the exact-size bytea directly rather than going
+ * through pq_begintypsend(), whose StringInfo starts with a 1 kB buffer.
+ */
+PG_FUNCTION_INFO_V1(ulid_send);
+Datum ulid_send(PG_FUNCTION_ARGS) {
+	pg_ulid_t *ulid = PG_GETARG_ULID_P(0);
+	bytea *result = (bytea *)palloc(VARHDRSZ + ULID_LEN);
+
+	SET_VARSIZE(result, VARHDRSZ + ULID_LEN);
+	memcpy(VARDATA(result), ulid->data, ULID_LEN);
+	PG_RETURN_BYTEA_P(result);
+}
+
+PG_FUNCTION_INFO_V1(ulid_lt);
+Datum ulid_lt(PG_FUNCTION_ARGS) {
+	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
+	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+
+	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) < 0);
+}
+
+PG_FUNCTION_INFO_V1(ulid_le);
+Datum ulid_le(PG_FUNCTION_ARGS) {
+	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
+	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+
+	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) <= 0);
+}
+
+PG_FUNCTION_INFO_V1(ulid_eq);
+Datum ulid_eq(PG_FUNCTION_ARGS) {
+	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
+	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+
+	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) == 0);
+}
+
+PG_FUNCTION_INFO_V1(ulid_ge);
+Datum ulid_ge(PG_FUNCTION_ARGS) {
+	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
+	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+
+	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) >= 0);
+}
+
+PG_FUNCTION_INFO_V1(ulid_gt);
+Datum ulid_gt(PG_FUNCTION_ARGS) {
+	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
+	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+
+	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) > 0);
+}
+
+PG_FUNCTION_INFO_V1(ulid_ne);
+Datum ulid_ne(PG_FUNCTION_ARGS) {
+	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
+	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+
+	PG_RETURN_BOOL(ulid_internal_cmp(arg1, arg2) != 0);
+}
+
+/* handler for btree index operator */
+PG_FUNCTION_INFO_V1(ulid_cmp);
+Datum ulid_cmp(PG_FUNCTION_ARGS) {
+	const pg_ulid_t *arg1 = PG_GETARG_ULID_P(0);
+	const pg_ulid_t *arg2 = PG_GETARG_ULID_P(1);
+
+	PG_RETURN_INT32(ulid_internal_cmp(arg1, arg2));
+}
+
+/*
+ * Cross-type comparisons between a ULID and a timestamptz.
+ *
+ * A ULID is ordered as if it lay just after the start of its millisecond,
+ * so it never equals a timestamp: it sorts before every timestamp later
+ * than its millisecond starts and after every other one.  "id < ts" and
+ * "id <= ts" both mean ulid_timestamp(id) < ts, and "id > ts" and
+ * "id >= ts" both mean ulid_timestamp(id) >= ts.  This is a single total
+ * order, which lets the operators share the btree family of ulid.
+ */
+static inline bool ulid_before_timestamptz(const pg_ulid_t *ulid,
+                                           TimestampTz ts) {
+	return ulid_ms_to_timestamptz(ulid_get_timestamp(ulid)) < ts;
+}
+
+PG_FUNCTION_INFO_V1(ulid_lt_timestamptz);
+Datum ulid_lt_timestamptz(PG_FUNCTION_ARGS) {
+	PG_RETURN_BOOL(ulid_before_timestamptz(PG_GETARG_ULID_P(0),
+	                                       PG_GETARG_TIMESTAMPTZ(1)));
+}
+
+PG_FUNCTION_INFO_V1(ulid_ge_timestamptz);
+Datum ulid_ge_timestamptz(PG_FUNCTION_ARGS) {
+	PG_RETURN_BOOL(!ulid_before_timestamptz(PG_GETARG_ULID_P(0),
+	                                        PG_GETARG_TIMESTAMPTZ(1)));
+}
+
+PG_FUNCTION_INFO_V1(timestamptz_gt_ulid);
+Datum timestamptz_gt_ulid(PG_FUNCTION_ARGS) {
+	PG_RETURN_BOOL(ulid_before_timestamptz(PG_GETARG_ULID_P(1),
+	                                       PG_GETARG_TIMESTAMPTZ(0)));
+}
+
+PG_FUNCTION_INFO_V1(timestamptz_le_ulid);
+Datum timestamptz_le_ulid(PG_FUNCTION_ARGS) {
+	PG_RETURN_BOOL(!ulid_before_timestamptz(PG_GETARG_ULID_P(1),
+	                                        PG_GETARG_TIMESTAMPTZ(0)));
+}
+
+/*
+ * Btree support function for ulid vs timestamptz; never returns 0.
+ */
+PG_FUNCTION_INFO_V1(ulid_cmp_timestamptz);
+Datum ulid_cmp_timestamptz(PG_FUNCTION_ARGS) {
+	PG_RETURN_INT32(ulid_before_timestamptz(PG_GETARG_ULID_P(0),
+	                                        PG_GETARG_TIMESTAMPTZ(1))
+	                    ? -1
+	                    : 1);
+}
+
+/* pg_statistic kinds stored by ulid_typanalyze(), from the private range */
+#define ULID_STATISTIC_KIND_TIME_HISTOGRAM 10701
+#define ULID_STATISTIC_KIND_DAY_DENSITY 10702
+
+/*
+ * Returns the timestamp of a ULID in milliseconds, with the top 16 random
+ * bits as the fraction, a scale on which ULIDs can be interpolated.
+ */
+static double ulid_time_key(const pg_ulid_t *ulid) {
+	uint64 prefix;
+
+	memcpy(&prefix, ulid->data, sizeof(prefix));
+	return (double)pg_ntoh64(prefix) / 65536.0;
+}
+
+/*
+ * Returns the smallest ULID that is not before the given timestamp, so that
+ * "id < ts" holds exactly when id is below it.
+ */
+static pg_ulid_t *ulid_timestamptz_cut(TimestampTz ts) {
+	TimestampTz min_ts = ulid_ms_to_timestamptz(0);
+	TimestampTz max_ts = ulid_ms_to_timestamptz(ULID_MAX_TIMESTAMP_MS);
+	uint64 ms;
+
+	if (ts <= min_ts) {
+		ms = 0;
+	} else if (ts >= max_ts) {
+		ms = ULID_MAX_TIMESTAMP_MS;
+	} else {
+		ms = ulid_timestamptz_to_ms(ts);
+		if ((ts - min_ts) % 1000 != 0) {
+			ms++;
+		}
+	}
+
+	return ulid_bound_at(ms, false);
+}
+
+/*
+ * Estimates the fraction of the rows below key, given the histogram bounds
+ * on the ulid_time_key() scale.
+ *
+ * Within the histogram, the position inside a bucket is interpolated
+ * linearly instead of being taken as the middle of the bucket, as the
+ * generic estimator does for types it cannot convert to a scalar.
+ *
+ * Rows newer than the last bound were inserted since ANALYZE.  They are
+ * taken to form a tail running from the last bound up to the current time,
+ * which holds a share of the rows on top of the histogram population.  With
+ * a known tail_rate (fraction of rows per millisecond) that share is capped
+ * at the share of new rows that triggers an autovacuum ANALYZE; otherwise it
+ * follows the density of the last bucket and is capped at one bucket.  The
+ * tail is spread evenly over its time range, so the fraction never
+ * decreases as key moves later.
+ */
+static double ulid_histogram_fraction(const double *bounds, int nbounds,
+                                      double key, double tail_rate) {
+	double bucket = 1.0 / (nbounds - 1);
+	double last = bounds[nbounds - 1];
+	double now_key = (double)(ulid_current_ms() + 1);
+	double tail = 0.0;
+	double binfrac;
+	int lo = 0;
+	int hi = nbounds - 1;
+
+	if (now_key > last) {
+		double width = last - bounds[nbounds - 2];
+
+		if (tail_rate > 0.0) {
+			tail = Min(tail_rate * (now_key - last), autovacuum_anl_scale);
+		} else if (width > 0.0) {
+			tail = Min((now_key - last) / width, 1.0) * bucket;
+		}
+	}
+
+	if (key <= bounds[0]) {
+		return 0.0;
+	}
+
+	if (key > last) {
+		if (now_key <= key) {
+			return 1.0;
+		}
+		return 1.0 - tail * (now_key - key) / (now_key - last);
+	}
+
+	/* Find the bucket with bounds[lo] < key <= bounds[hi] */
+	while (hi - lo > 1) {
+		int mid = (lo + hi) / 2;
+
+		if (bounds[mid] < key) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+
+	binfrac = bounds[hi] > bounds[lo]
+	              ? (key - bounds[lo]) / (bounds[hi] - bounds[lo])
+	              : 0.5;
+	binfrac = Min(Max(binfrac, 0.0), 1.0);
+
+	return (lo + binfrac) * bucket * (1.0 - tail);
+}
+
+/* Converts a timestamptz stored by ulid_typanalyze() to milliseconds */
+static double ulid_stats_ms(Datum value) {
+	return (double)ulid_timestamptz_to_ms(DatumGetTimestampTz(value));
+}
+
+/*
+ * Returns the fraction of rows per millisecond in the last day of the
+ * density sketch, which runs up to newest, the newest timestamp sampled.
+ * When that day is less than an hour old, the day before is included.
+ */
+static double ulid_tail_rate(const AttStatsSlot *sketch, double newest) {
+	int last = sketch->nvalues - 1;
+	double start = ulid_stats_ms(sketch->values[last]);
+	double fraction = sketch->numbers[last];
+
+	if (newest - start < USECS_PER_HOUR / 1000 && last > 0) {
+		start = ulid_stats_ms(sketch->values[last - 1]);
+		fraction += sketch->numbers[last - 1];
+	}
+
+	return fraction / (newest + 1.0 - start);
+}
+
+/*
+ * Estimates the fraction of the non-null rows below key from the time
+ * histogram and density sketch of ulid_typanalyze().  Returns false if the
+ * column was analyzed without them.
+ */
+static bool ulid_time_stats_fraction(HeapTuple statsTuple, double key,
+                                     double *fraction) {
+	AttStatsSlot hslot;
+	AttStatsSlot dslot;
+	double *bounds;
+	double tail_rate = 0.0;
+
+	if (!get_attstatsslot(&hslot, statsTuple,
+	                      ULID_STATISTIC_KIND_TIME_HISTOGRAM, InvalidOid,
+	                      ATTSTATSSLOT_VALUES)) {
+		return false;
+	}
+	if (hslot.nvalues < 2) {
+		free_attstatsslot(&hslot);
+		return false;
+	}
+
+	bounds = palloc(hslot.nvalues * sizeof(double));
+	for (int i = 0; i < hslot.nvalues; i++) {
+		bounds[i] = ulid_stats_ms(hslot.values[i]);
+	}
+
+	if (get_attstatsslot(&dslot, statsTuple, ULID_STATISTIC_KIND_DAY_DENSITY,
+	                     InvalidOid, ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS)) {
+		if (dslot.nvalues > 0 && dslot.nvalues == dslot.nnumbers) {
+			tail_rate = ulid_tail_rate(&dslot, bounds[hslot.nvalues - 1]);
+		}
+		free_attstatsslot(&dslot);
+	}
+
+	*fraction = ulid_histogram_fraction(bounds, hslot.nvalues, key, tail_rate);
+
+	pfree(bounds);
+	free_attstatsslot(&hslot);
+	return true;
+}
+
+/*
+ * Restriction selectivity of "var op constant" for the inequality
+ * operators, with var a ulid column and the constant a ulid or timestamptz.
+ *
+ * Uses the statistics of ulid_typanalyze() where present; they cover every
+ * non-null row.  Otherwise follows scalarineqsel(): the most common values
+ * are checked one by one and the rest is estimated from the histogram.  A
+ * timestamptz is replaced by ulid_timestamptz_cut(), which turns every
+ * cross-type comparison into "id < cut" or "id >= cut".  Anything else (no
+ * statistics, a value unknown at plan time) is left to the generic
+ * estimator.
+ */
+static Datum ulid_ineqsel(FunctionCallInfo fcinfo, PGFunction generic,
+                          bool isgt, bool iseq) {
+	PlannerInfo *root = (PlannerInfo *)PG_GETARG_POINTER(0);
+	List *args = (List *)PG_GETARG_POINTER(2);
+	int varRelid = PG_GETARG_INT32(3);
+	VariableStatData vardata;
+	AttStatsSlot sslot;
+	Node *other;
+	Const *value;
+	bool varonleft;
+	const pg_ulid_t *bound;
+	double nullfrac;
+	double sumcommon = 0.0;
+	double mcv_selec = 0.0;
+	double hist_selec = 0.5;
+	double selec;
+
+	if (!get_restriction_variable(root, args, varRelid, &vardata, &other,
+	                              &varonleft)) {
+		return generic(fcinfo);
+	}
+
+	value = (Const *)other;
+	if (!IsA(other, Const) || value->constisnull ||
+	    !HeapTupleIsValid(vardata.statsTuple) ||
+	    (value->consttype != vardata.vartype &&
+	     value->consttype != TIMESTAMPTZOID)) {
+		ReleaseVariableStats(vardata);
+		return generic(fcinfo);
+	}
+
+	/* Estimate as "var op constant" */
+	if (!varonleft) {
+		isgt = !isgt;
+	}
+
+	if (value->consttype == vardata.vartype) {
+		bound = DatumGetULIDP(value->constvalue);
+	} else {
+		bound = ulid_timestamptz_cut(DatumGetTimestampTz(value->constvalue));
+		iseq = isgt;
+	}
+
+	nullfrac = ((Form_pg_statistic)GETSTRUCT(vardata.statsTuple))->stanullfrac;
+
+	if (ulid_time_stats_fraction(vardata.statsTuple, ulid_time_key(bound),
+	                             &hist_selec)) {
+		ReleaseVariableStats(vardata);
+
+		selec = (1.0 - nullfrac) * (isgt ? 1.0 - hist_selec : hist_selec);
+		CLAMP_PROBABILITY(selec);
+		PG_RETURN_FLOAT8(selec);
+	}
+
+	if (get_attstatsslot(&sslot, vardata.statsTuple, STATISTIC_KIND_MCV,
+	                     InvalidOid, ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS)) {
+		for (int i = 0; i < sslot.nvalues; i++) {
+			int cmp = ulid_internal_cmp(DatumGetULIDP(sslot.values[i]), bound);
+
+			if ((isgt ? cmp > 0 : cmp < 0) || (iseq && cmp == 0)) {
+				mcv_selec += sslot.numbers[i];
+			}
+			sumcommon += sslot.numbers[i];
+		}
+		free_attstatsslot(&sslot);
+	}
+
+	if (get_attstatsslot(&sslot, vardata.statsTuple, STATISTIC_KIND_HISTOGRAM,
+	                     InvalidOid, ATTSTATSSLOT_VALUES)) {
+		if (sslot.nvalues >= 2) {
+			double *bounds = palloc(sslot.nvalues * sizeof(double));
+
+			for (int i = 0; i < sslot.nvalues; i++) {
+				bounds[i] = ulid_time_key(DatumGetULIDP(sslot.values[i]));
+			}
+			hist_selec = ulid_histogram_fraction(bounds, sslot.nvalues,
+			                                     ulid_time_key(bound), 0.0);
+			if (isgt) {
+				hist_selec = 1.0 - hist_selec;
+			}
+			pfree(bounds);
+		}
+		free_attstatsslot(&sslot);
+	}
+
+	ReleaseVariableStats(vardata);
+
+	selec = (1.0 - nullfrac - sumcommon) * hist_selec + mcv_selec;
+	CLAMP_PROBABILITY(selec);
+	PG_RETURN_FLOAT8(selec);
+}
+
+PG_FUNCTION_INFO_V1(ulid_ltsel);
+Datum ulid_ltsel(PG_FUNCTION_ARGS) {
+	return ulid_ineqsel(fcinfo, scalarltsel, false, false);
+}
+
+PG_FUNCTION_INFO_V1(ulid_lesel);
+Datum ulid_lesel(PG_FUNCTION_ARGS) {
+	return ulid_ineqsel(fcinfo, scalarlesel, false, true);
+}
+
+PG_FUNCTION_INFO_V1(ulid_gtsel);
+Datum ulid_gtsel(PG_FUNCTION_ARGS) {
+	return ulid_ineqsel(fcinfo, scalargtsel, true, false);
+}
+
+PG_FUNCTION_INFO_V1(ulid_gesel);
+Datum ulid_gesel(PG_FUNCTION_ARGS) {
+	return ulid_ineqsel(fcinfo, scalargesel, true, true);
+}
+
+/* ANALYZE state of a ulid column, wrapping that of std_typanalyze() */
+typedef struct UlidAnalyzeData {
+	AnalyzeAttrComputeStatsFunc std_compute_stats;
+	void *std_extra_data;
+} UlidAnalyzeData;
+
+static int ulid_ms_cmp(const void *a, const void *b) {
+	uint64 x = *(const uint64 *)a;
+	uint64 y = *(const uint64 *)b;
+
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/*
+ * Fills the first statistics slot left free by the standard statistics with
+ * timestamptz values.  Returns false if there is none.
+ */
+static bool ulid_stats_store(VacAttrStats *stats, int16 kind, Datum *values,
+                             int nvalues, float4 *numbers, int nnumbers) {
+	for (int slot = 0; slot < STATISTIC_NUM_SLOTS; slot++) {
+		if (stats->stakind[slot] != 0) {
+			continue;
+		}
+
+		stats->stakind[slot] = kind;
+		stats->staop[slot] = InvalidOid;
+		stats->stacoll[slot] = InvalidOid;
+		stats->stavalues[slot] = values;
+		stats->numvalues[slot] = nvalues;
+		stats->stanumbers[slot] = numbers;
+		stats->numnumbers[slot] = nnumbers;
+		stats->statypid[slot] = TIMESTAMPTZOID;
+		get_typlenbyvalalign(TIMESTAMPTZOID, &stats->statyplen[slot],
+		                     &stats->statypbyval[slot],
+		                     &stats->statypalign[slot]);
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Computes the standard statistics, then the timestamp statistics read by
+ * ulid_ineqsel():
+ *
+ * - ULID_STATISTIC_KIND_TIME_HISTOGRAM: an equi-depth histogram of the
+ *   timestamps of all non-null sampled rows, starting at the oldest and
+ *   ending at the newest.  Unlike the standard histogram it leaves out the
+ *   random component and does not exclude the most common values.
+ * - ULID_STATISTIC_KIND_DAY_DENSITY: the start of each UTC day in the
+ *   sample, most recent days first up to the statistics target, with the
+ *   fraction of non-null rows in that day.  It gives the current insert
+ *   rate, which the histogram only resolves to one bucket.
+ */
+static void ulid_compute_stats(VacAttrStats *stats,
+                               AnalyzeAttrFetchFunc fetchfunc, int samplerows,
+                               double totalrows) {
+	const uint64 ms_per_day = USECS_PER_DAY / 1000;
+	UlidAnalyzeData *data = (UlidAnalyzeData *)stats->extra_data;
+	int target = ULID_STATS_TARGET(stats);
+	MemoryContext old_context;
+	uint64 *times;
+	Datum *hist;
+	Datum *days;
+	float4 *density;
+	int ntimes = 0;
+	int nhist;
+	int ndays = 0;
+
+	stats->extra_data = data->std_extra_data;
+	data->std_compute_stats(stats, fetchfunc, samplerows, totalrows);
+	stats->extra_data = data;
+
+	if (!stats->stats_valid) {
+		return;
+	}
+
+	times = palloc(samplerows * sizeof(uint64));
+	for (int i = 0; i < samplerows; i++) {
+		bool isnull;
+		Datum value = fetchfunc(stats, i, &isnull);
+
+		if (!isnull) {
+			times[ntimes++] = ulid_get_timestamp(DatumGetULIDP(value));
+		}
+	}
+
+	if (ntimes < 2) {
+		pfree(times);
+		return;
+	}
+
+	qsort(times, ntimes, sizeof(uint64), ulid_ms_cmp);
+
+	old_context = MemoryContextSwitchTo(stats->anl_context);
+
+	nhist = Min(ntimes, target + 1);
+	hist = palloc(nhist * sizeof(Datum));
+	for (int i = 0; i < nhist; i++) {
+		uint64 ms = times[(int64)i * (ntimes - 1) / (nhist - 1)];
+
+		hist[i] = TimestampTzGetDatum(ulid_ms_to_timestamptz(ms));
+	}
+
+	days = palloc(target * sizeof(Datum));
+	density = palloc(target * sizeof(float4));
+	for (int last = ntimes - 1; last >= 0 && ndays < target; ndays++) {
+		uint64 day = times[last] / ms_per_day;
+		int first = last;
+
+		while (first > 0 && times[first - 1] / ms_per_day == day) {
+			first--;
+		}
+
+		days[ndays] =
+			TimestampTzGetDatum(ulid_ms_to_timestamptz(day * ms_per_day));
+		density[ndays] = (float4)(last - first + 1) / ntimes;
+		last = first - 1;
+	}
+
+	/* Store the days oldest first */
+	for (int i = 0; i < ndays / 2; i++) {
+		Datum day = days[i];
+		float4 fraction = density[i];
+
+		days[i] = days[ndays - 1 - i];
+		density[i] = density[ndays - 1 - i];
+		days[ndays - 1 - i] = day;
+		density[ndays - 1 - i] = fraction;
+	}
+
+	MemoryContextSwitchTo(old_context);
+
+	if (ulid_stats_store(stats, ULID_STATISTIC_KIND_TIME_HISTOGRAM, hist,
+	                     nhist, NULL, 0)) {
+		ulid_stats_store(stats, ULID_STATISTIC_KIND_DAY_DENSITY, days, ndays,
+		                 density, ndays);
+	}
+
+	pfree(times);
+}
+
+/*
+ * Type analyze function: sets up the standard statistics and adds the
+ * timestamp statistics of ulid_compute_stats() on top.
+ */
+PG_FUNCTION_INFO_V1(ulid_typanalyze);
+Datum ulid_typanalyze(PG_FUNCTION_ARGS) {
+	VacAttrStats *stats = (VacAttrStats *)PG_GETARG_POINTER(0);
+	UlidAnalyzeData *data;
+
+	if (!std_typanalyze(stats)) {
+		PG_RETURN_BOOL(false);
+	}
+
+	data = palloc(sizeof(UlidAnalyzeData));
+	data->std_compute_stats = stats->compute_stats;
+	data->std_extra_data = stats->extra_data;
+	stats->compute_stats = ulid_compute_stats;
+	stats->extra_data = data;
+
+	PG_RETURN_BOOL(true);
 }
 
 /*
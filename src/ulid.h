@@ -24,6 +24,28 @@
 #define ULID_LEN 16
 /* ULID encoded string length (26 characters in Crockford base32) */
 #define ULID_ENCODED_LEN 26
+/* Length of the big-endian millisecond timestamp (bytes 0-5) */
+#define ULID_TIMESTAMP_LEN 6
+/* Length of the random component (bytes 6-15) */
+#define ULID_RANDOM_LEN (ULID_LEN - ULID_TIMESTAMP_LEN)
+/* Largest millisecond timestamp representable in 48 bits */
+#define ULID_MAX_TIMESTAMP_MS ((UINT64CONST(1) << 48) - 1)
+
+/* Default and maximum number of random-component bits holding a node id */
+#define ULID_NODE_BITS_DEFAULT 16
+#define ULID_NODE_BITS_MAX 31
+
+/* Default and maximum size of the per-backend entropy pool, in bytes */
+#define ULID_ENTROPY_POOL_DEFAULT 4096
+#define ULID_ENTROPY_POOL_MAX 65536
+
+/* ChaCha20 random source parameters */
+#define ULID_CHACHA_KEY_LEN 32
+#define ULID_CHACHA_NONCE_LEN 12
+#define ULID_CHACHA_SEED_LEN (ULID_CHACHA_KEY_LEN + ULID_CHACHA_NONCE_LEN)
+#define ULID_CHACHA_BLOCK_LEN 64
+/* Reseed from pg_strong_random() after this many bytes of output */
+#define ULID_CHACHA_RESEED_BYTES (1024 * 1024)
 
 typedef struct pg_ulid_t {
 	unsigned char data[ULID_LEN];
@@ -87,4 +109,38 @@ static inline int ulid_internal_cmp(const pg_ulid_t *arg1,
 	return memcmp(arg1->data, arg2->data, ULID_LEN);
 }
 
+/*
+ * Stores a 48-bit millisecond timestamp in bytes 0-5 (big-endian).
+ */
+static inline void ulid_set_timestamp(pg_ulid_t *ulid, uint64 ms) {
+	ulid->data[0] = (unsigned char)(ms >> 40);
+	ulid->data[1] = (unsigned char)(ms >> 32);
+	ulid->data[2] = (unsigned char)(ms >> 24);
+	ulid->data[3] = (unsigned char)(ms >> 16);
+	ulid->data[4] = (unsigned char)(ms >> 8);
+	ulid->data[5] = (unsigned char)ms;
+}
+
+/*
+ * Reads the 48-bit millisecond timestamp from bytes 0-5 (big-endian).
+ */
+static inline uint64 ulid_get_timestamp(const pg_ulid_t *ulid) {
+	return ((uint64)ulid->data[0] << 40) | ((uint64)ulid->data[1] << 32) |
+	       ((uint64)ulid->data[2] << 24) | ((uint64)ulid->data[3] << 16) |
+	       ((uint64)ulid->data[4] << 8) | (uint64)ulid->data[5];
+}
+
+/*
+ * Stores an 80-bit random component, given as its high 16 bits and low
+ * 64 bits, in bytes 6-15 (big-endian).
+ */
+static inline void ulid_set_random(pg_ulid_t *ulid, uint16 hi, uint64 lo) {
+	ulid->data[6] = (unsigned char)(hi >> 8);
+	ulid->data[7] = (unsigned char)hi;
+	for (int i = 15; i >= 8; i--) {
+		ulid->data[i] = (unsigned char)lo;
+		lo >>= 8;
+	}
+}
+
 #endif // ULID_ULID_H
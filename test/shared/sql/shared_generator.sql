@@ -0,0 +1,80 @@
+-- Shared generator tests
+-- Run by make check-shared in a temporary instance that preloads the library
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Verify the shared state is available
+SELECT ulid_shared_retries() >= 0 AS available;
+
+-- The 64-bit (timestamp, sequence) word of a ULID
+CREATE FUNCTION ulid_shared_clock(id ulid) RETURNS bigint AS $$
+    SELECT ('x' || encode(substring(id::bytea FROM 1 FOR 8), 'hex'))::bit(64)::bigint
+$$ LANGUAGE sql IMMUTABLE;
+
+-- Verify ULIDs from one session are unique and strictly increasing, each
+-- one either stepping the sequence (carrying into the next millisecond when
+-- it overflows) or starting a later millisecond at sequence zero
+CREATE TABLE shared_serial AS
+SELECT n, gen_shared_ulid() AS id FROM generate_series(1, 5000) AS n;
+SELECT COUNT(*) AS total_rows, COUNT(DISTINCT id) AS distinct_ids,
+       COUNT(*) FILTER (WHERE id <= prev) AS out_of_order,
+       COUNT(*) FILTER (WHERE clock <> prev_clock + 1 AND clock & 65535 <> 0) AS bad_steps
+FROM (SELECT id, lag(id) OVER w AS prev, ulid_shared_clock(id) AS clock,
+             lag(ulid_shared_clock(id)) OVER w AS prev_clock
+      FROM shared_serial WINDOW w AS (ORDER BY n)) s;
+
+-- Encourage a parallel plan even for a small table
+CREATE TABLE shared_parallel_src AS SELECT n FROM generate_series(1, 20000) AS n;
+ANALYZE shared_parallel_src;
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET min_parallel_table_scan_size = 0;
+SET max_parallel_workers_per_gather = 2;
+
+-- Verify the workers call gen_shared_ulid() themselves
+EXPLAIN (COSTS OFF, VERBOSE) SELECT n, gen_shared_ulid() AS id FROM shared_parallel_src;
+
+-- Verify ULIDs generated concurrently by the leader and workers are unique,
+-- down to the (timestamp, sequence) word the processes compete for
+CREATE TABLE shared_parallel AS SELECT n, gen_shared_ulid() AS id FROM shared_parallel_src;
+SELECT COUNT(*) AS total_rows, COUNT(DISTINCT id) AS distinct_ids,
+       COUNT(DISTINCT ulid_shared_clock(id)) AS distinct_clocks
+FROM shared_parallel;
+
+-- Verify the instance-wide order: the parallel batch sorts after the serial
+-- one, and a later call after both
+SELECT (SELECT MIN(id) FROM shared_parallel) > (SELECT MAX(id) FROM shared_serial) AS after_serial,
+       gen_shared_ulid() > (SELECT MAX(id) FROM shared_parallel) AS after_parallel;
+
+-- Verify gen_node_ulid() draws its counter from shared memory: with 16 node
+-- bits, bytes 8-9 hold a sequence that steps like that of gen_shared_ulid()
+SET ulid.node_id = 7;
+SET ulid.node_bits = 16;
+CREATE TABLE shared_node AS
+SELECT n, gen_node_ulid() AS id FROM generate_series(1, 5000) AS n;
+SELECT COUNT(*) AS total_rows, COUNT(DISTINCT id) AS distinct_ids,
+       COUNT(*) FILTER (WHERE id <= prev) AS out_of_order,
+       COUNT(*) FILTER (WHERE ulid_node_id(id, 16) <> 7) AS wrong_node,
+       COUNT(*) FILTER (WHERE clock <> prev_clock + 1 AND clock & 65535 <> 0) AS bad_steps
+FROM (SELECT id, lag(id) OVER w AS prev, clock, lag(clock) OVER w AS prev_clock
+      FROM (SELECT n, id,
+                   (ulid_shared_clock(id) >> 16 << 16) +
+                   get_byte(id::bytea, 8) * 256 + get_byte(id::bytea, 9) AS clock
+            FROM shared_node) c
+      WINDOW w AS (ORDER BY n)) s;
+
+-- Cleanup
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET min_parallel_table_scan_size;
+RESET max_parallel_workers_per_gather;
+RESET ulid.node_id;
+RESET ulid.node_bits;
+DROP TABLE shared_parallel;
+DROP TABLE shared_parallel_src;
+DROP TABLE shared_serial;
+DROP TABLE shared_node;
+DROP FUNCTION ulid_shared_clock(ulid);
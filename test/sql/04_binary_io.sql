@@ -42,6 +42,27 @@ SELECT * FROM ulids_dest ORDER BY ulid_test1;
 SELECT COUNT(*) AS src_count FROM ulids_src;
 SELECT COUNT(*) AS dest_count FROM ulids_dest;
 
+-- Verify ulid_send() produces exactly the 16 bytes of the value
+SELECT ulid_send('01ARZ3NDEKTSV4RRFFQ69G5FAV') AS sent,
+       octet_length(ulid_send('01ARZ3NDEKTSV4RRFFQ69G5FAV')) AS sent_length;
+SELECT COUNT(*) FILTER (WHERE ulid_send(ulid_test1) <> ulid_test1::bytea) AS send_mismatches
+FROM ulids_src;
+
+-- Test a larger binary round trip including NULLs and arrays
+CREATE TABLE ulids_many AS
+SELECT n, CASE WHEN n % 100 = 0 THEN NULL ELSE gen_random_ulid() END AS id,
+       gen_random_ulid_array(n % 5) AS ids
+FROM generate_series(1, 10000) AS n;
+CREATE TABLE ulids_many_dest (LIKE ulids_many);
+COPY ulids_many TO '/tmp/ulids_binary' WITH (FORMAT binary);
+COPY ulids_many_dest FROM '/tmp/ulids_binary' WITH (FORMAT binary);
+SELECT COUNT(*) AS rows_copied, COUNT(id) AS non_null_ids FROM ulids_many_dest;
+SELECT COUNT(*) AS mismatches
+FROM ulids_many s FULL JOIN ulids_many_dest d USING (n)
+WHERE s.id IS DISTINCT FROM d.id OR s.ids IS DISTINCT FROM d.ids;
+
 -- Cleanup
 DROP TABLE ulids_src;
 DROP TABLE ulids_dest;
+DROP TABLE ulids_many;
+DROP TABLE ulids_many_dest;
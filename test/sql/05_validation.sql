@@ -126,3 +126,31 @@ EXCEPTION
         -- Expected to fail
         NULL;
 END $$;
+
+-- Test error codes and soft error reporting: on PostgreSQL 16+ errors are
+-- collected by pg_input_error_info() without raising them
+CREATE FUNCTION ulid_input_error(input TEXT) RETURNS TEXT AS $$
+DECLARE
+    result TEXT;
+BEGIN
+    IF current_setting('server_version_num')::INT >= 160000 THEN
+        EXECUTE 'SELECT sql_error_code || '': '' || message FROM pg_input_error_info($1, ''ulid'')'
+            INTO result USING input;
+        RETURN coalesce(result, 'valid');
+    END IF;
+    BEGIN
+        PERFORM input::ulid;
+        RETURN 'valid';
+    EXCEPTION WHEN OTHERS THEN
+        RETURN SQLSTATE || ': ' || SQLERRM;
+    END;
+END;
+$$ LANGUAGE plpgsql;
+
+SELECT input, ulid_input_error(input) AS result
+FROM (VALUES ('01ARZ3NDEKTSV4RRFFQ69G5FAV'),
+             ('01ARZ3NDEKTSV4RRFFQ69G5FA'),
+             ('01ARZ3NDEKTSV4RRFFQ69G5FAI'),
+             ('81ARZ3NDEKTSV4RRFFQ69G5FAV')) AS t(input);
+
+DROP FUNCTION ulid_input_error(TEXT);
@@ -0,0 +1,111 @@
+-- ULID generator tests
+-- Tests ordering and uniqueness of the gen_*_ulid() generators
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Test gen_monotonic_ulid() function
+SELECT LENGTH(gen_monotonic_ulid()::TEXT) AS ulid_length;
+
+-- Generate a sequence of monotonic ULIDs in a single statement
+CREATE TEMPORARY TABLE ulid_monotonic AS
+SELECT n, gen_monotonic_ulid() AS id FROM generate_series(1, 10000) AS n;
+
+-- Verify all ULIDs are unique
+SELECT COUNT(DISTINCT id) = 10000 AS all_unique FROM ulid_monotonic;
+
+-- Verify generation order matches sort order
+SELECT bool_and(id > prev_id) AS strictly_increasing
+FROM (SELECT id, lag(id) OVER (ORDER BY n) AS prev_id FROM ulid_monotonic) s
+WHERE prev_id IS NOT NULL;
+
+-- Verify the sequence continues across statements
+SELECT gen_monotonic_ulid() > (SELECT MAX(id) FROM ulid_monotonic) AS continues_sequence;
+
+-- Test the coarse clock source
+SET ulid.clock_source = 'realtime_coarse';
+SELECT COUNT(DISTINCT id) AS distinct_ids
+FROM (SELECT gen_random_ulid() AS id FROM generate_series(1, 1000)) s;
+
+-- Verify the monotonic sequence survives switching to a coarser clock
+SELECT gen_monotonic_ulid() > (SELECT MAX(id) FROM ulid_monotonic) AS continues_sequence;
+RESET ulid.clock_source;
+
+-- Test gen_statement_ulid(): one timestamp per statement, in generation order
+CREATE TEMPORARY TABLE ulid_statement AS
+SELECT n, gen_statement_ulid() AS id FROM generate_series(1, 10000) AS n;
+SELECT COUNT(DISTINCT id) AS distinct_ids,
+       COUNT(DISTINCT LEFT(id::TEXT, 10)) AS timestamps
+FROM ulid_statement;
+SELECT bool_and(id > prev_id) AS strictly_increasing
+FROM (SELECT id, lag(id) OVER (ORDER BY n) AS prev_id FROM ulid_statement) s
+WHERE prev_id IS NOT NULL;
+
+-- Verify the timestamp does not move while the statement runs
+SELECT LEFT(a::TEXT, 10) = LEFT(b::TEXT, 10) AS same_timestamp, a < b AS increasing
+FROM (SELECT gen_statement_ulid() AS a, pg_sleep(0.01) AS s,
+             gen_statement_ulid() AS b) t;
+
+-- Verify a later statement continues the sequence
+SELECT gen_statement_ulid() > (SELECT MAX(id) FROM ulid_statement) AS continues_sequence;
+
+-- Test gen_ulid_at() with a supplied timestamp
+SELECT LEFT(gen_ulid_at('2016-07-30 23:54:10.259+00')::TEXT, 10) AS time_prefix;
+SELECT LEFT(gen_ulid_at('1970-01-01 00:00:00.000999+00')::TEXT, 10) AS epoch_prefix,
+       LEFT(gen_ulid_at('10889-08-02 05:31:50.655999+00')::TEXT, 10) AS max_prefix;
+SELECT COUNT(DISTINCT gen_ulid_at('2016-07-30 23:54:10.259+00')) AS distinct_ids
+FROM generate_series(1, 1000);
+
+-- Test timestamps that do not fit in a ULID
+SELECT gen_ulid_at('1969-12-31 23:59:59.999999+00');
+SELECT gen_ulid_at('10889-08-02 05:31:50.656+00');
+SELECT gen_ulid_at('infinity');
+
+-- Test gen_monotonic_ulid_at(): backfill rows in created_at order
+CREATE TEMPORARY TABLE ulid_backfill AS
+SELECT n, '2020-01-01 00:00:00+00'::timestamptz + (n / 10) * interval '1 ms' AS created_at
+FROM generate_series(1, 10000) AS n;
+CREATE TEMPORARY TABLE ulid_backfilled AS
+SELECT n, gen_monotonic_ulid_at(created_at) AS id FROM ulid_backfill ORDER BY n;
+
+-- Verify all ULIDs are unique and sort in created_at order
+SELECT COUNT(DISTINCT id) AS distinct_ids,
+       COUNT(DISTINCT LEFT(id::TEXT, 10)) AS timestamps
+FROM ulid_backfilled;
+SELECT bool_and(id > prev_id) AS strictly_increasing
+FROM (SELECT id, lag(id) OVER (ORDER BY n) AS prev_id FROM ulid_backfilled) s
+WHERE prev_id IS NOT NULL;
+
+-- Verify an earlier timestamp keeps its own prefix instead of being clamped
+SELECT gen_monotonic_ulid_at('2016-07-30 23:54:10.259+00') < (SELECT MIN(id) FROM ulid_backfilled) AS keeps_timestamp;
+
+-- Test gen_random_ulids() batch generation
+SELECT COUNT(*) AS batch_size, COUNT(DISTINCT id) AS distinct_ids
+FROM gen_random_ulids(10000) AS id;
+
+-- Verify a batch is emitted in sorted order and shares one timestamp
+SELECT bool_and(id > prev_id) AS strictly_increasing,
+       COUNT(DISTINCT LEFT(id::TEXT, 10)) AS timestamps
+FROM (SELECT id, lag(id) OVER (ORDER BY n) AS prev_id
+      FROM gen_random_ulids(10000) WITH ORDINALITY AS g(id, n)) s
+WHERE prev_id IS NOT NULL;
+
+-- Test gen_random_ulid_array() batch generation
+SELECT cardinality(gen_random_ulid_array(1000)) AS array_size;
+SELECT bool_and(id > prev_id) AS strictly_increasing
+FROM (SELECT id, lag(id) OVER (ORDER BY n) AS prev_id
+      FROM unnest(gen_random_ulid_array(1000)) WITH ORDINALITY AS g(id, n)) s
+WHERE prev_id IS NOT NULL;
+
+-- Test empty and invalid batch sizes
+SELECT COUNT(*) AS batch_size FROM gen_random_ulids(0);
+SELECT gen_random_ulid_array(0) AS empty_array;
+SELECT COUNT(*) FROM gen_random_ulids(-1);
+
+-- Cleanup
+DROP TABLE ulid_monotonic;
+DROP TABLE ulid_statement;
+DROP TABLE ulid_backfill;
+DROP TABLE ulid_backfilled;
@@ -0,0 +1,76 @@
+-- ULID entropy source tests
+-- Tests the per-backend entropy pool used for the random component
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Loading the module defines the GUC with its default pool size
+SELECT LENGTH(gen_random_ulid()::TEXT) AS ulid_length;
+SHOW ulid.entropy_pool_size;
+
+-- Test generation with the pool disabled (one pg_strong_random() per ULID)
+SET ulid.entropy_pool_size = 0;
+CREATE TEMPORARY TABLE ulid_entropy AS
+SELECT gen_random_ulid() AS id FROM generate_series(1, 1000);
+
+-- Test generation with a pool smaller than a single ULID's random component
+SET ulid.entropy_pool_size = 8;
+INSERT INTO ulid_entropy SELECT gen_random_ulid() FROM generate_series(1, 1000);
+
+-- Test generation across many refills of the largest pool
+SET ulid.entropy_pool_size = '64kB';
+INSERT INTO ulid_entropy SELECT gen_random_ulid() FROM generate_series(1, 20000);
+
+-- Test switching back to the default pool size mid-session
+RESET ulid.entropy_pool_size;
+INSERT INTO ulid_entropy SELECT gen_monotonic_ulid() FROM generate_series(1, 1000);
+
+-- Verify all ULIDs are unique
+SELECT COUNT(*) AS total, COUNT(DISTINCT id) AS distinct_ids FROM ulid_entropy;
+
+-- Test the ChaCha20 random source, with and without the pool
+SHOW ulid.random_source;
+SET ulid.random_source = 'chacha';
+TRUNCATE ulid_entropy;
+INSERT INTO ulid_entropy SELECT gen_random_ulid() FROM generate_series(1, 10000);
+SET ulid.entropy_pool_size = 0;
+INSERT INTO ulid_entropy SELECT gen_random_ulid() FROM generate_series(1, 1000);
+RESET ulid.entropy_pool_size;
+SELECT COUNT(*) AS total, COUNT(DISTINCT id) AS distinct_ids FROM ulid_entropy;
+
+-- Statistical self-tests of the random component for each source,
+-- over 10,000 ULIDs (100,000 random bytes) per source
+CREATE TEMPORARY TABLE ulid_random_bytes (source TEXT, b INT);
+INSERT INTO ulid_random_bytes
+SELECT 'chacha', get_byte(ulid_send(id), i)
+FROM (SELECT gen_random_ulid() AS id FROM generate_series(1, 10000)) g,
+     generate_series(6, 15) AS i;
+SET ulid.random_source = 'strong';
+INSERT INTO ulid_random_bytes
+SELECT 'strong', get_byte(ulid_send(id), i)
+FROM (SELECT gen_random_ulid() AS id FROM generate_series(1, 10000)) g,
+     generate_series(6, 15) AS i;
+
+-- Monobit test: one bits must be within 400,000 +/- 4,000 of 800,000
+-- (about 9 standard deviations)
+SELECT source, COUNT(*) AS bytes,
+       abs(SUM(LENGTH(REPLACE(b::BIT(8)::TEXT, '0', ''))) - 400000) < 4000 AS monobit_ok
+FROM ulid_random_bytes GROUP BY source ORDER BY source;
+
+-- Byte frequency test: chi-square over 256 values (255 degrees of freedom,
+-- mean 255, standard deviation 22.6) must stay below 400
+SELECT s.source,
+       SUM((COALESCE(c.n, 0) - 390.625) ^ 2 / 390.625) < 400 AS chi_square_ok
+FROM (VALUES ('chacha'), ('strong')) AS s(source)
+CROSS JOIN generate_series(0, 255) AS v
+LEFT JOIN (SELECT source, b, COUNT(*) AS n FROM ulid_random_bytes GROUP BY source, b) c
+    ON c.source = s.source AND c.b = v
+GROUP BY s.source ORDER BY s.source;
+
+-- Cleanup
+RESET ulid.entropy_pool_size;
+RESET ulid.random_source;
+DROP TABLE ulid_random_bytes;
+DROP TABLE ulid_entropy;
@@ -0,0 +1,41 @@
+-- ULID parallel query tests
+-- Tests parallel safety markings and generation in parallel workers
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Verify parallel safety of the generators (s = safe, r = restricted)
+SELECT proname, proparallel FROM pg_proc
+WHERE proname IN ('gen_random_ulid', 'gen_monotonic_ulid', 'gen_statement_ulid',
+                  'gen_random_ulids', 'gen_random_ulid_array', 'gen_shared_ulid')
+ORDER BY proname;
+
+-- Verify the shared generator refuses to run without the preloaded library
+-- (see test/shared for the preloaded case)
+SELECT gen_shared_ulid();
+SELECT ulid_shared_retries();
+
+-- Encourage a parallel plan even for a small table
+CREATE TABLE ulid_parallel_src AS SELECT n FROM generate_series(1, 100000) AS n;
+ANALYZE ulid_parallel_src;
+SET parallel_setup_cost = 0;
+SET parallel_tuple_cost = 0;
+SET min_parallel_table_scan_size = 0;
+SET max_parallel_workers_per_gather = 2;
+
+-- Verify gen_random_ulid() does not prevent a parallel plan
+EXPLAIN (COSTS OFF) SELECT n, gen_random_ulid() AS id FROM ulid_parallel_src;
+
+-- Verify ULIDs generated by parallel workers are unique
+CREATE TABLE ulid_parallel AS SELECT n, gen_random_ulid() AS id FROM ulid_parallel_src;
+SELECT COUNT(*) AS total_rows, COUNT(DISTINCT id) AS distinct_ids FROM ulid_parallel;
+
+-- Cleanup
+RESET parallel_setup_cost;
+RESET parallel_tuple_cost;
+RESET min_parallel_table_scan_size;
+RESET max_parallel_workers_per_gather;
+DROP TABLE ulid_parallel;
+DROP TABLE ulid_parallel_src;
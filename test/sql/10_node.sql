@@ -0,0 +1,51 @@
+-- ULID node identifier tests
+-- Tests gen_node_ulid() and the ulid_node_id() extractors
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Loading the module defines the node GUCs
+SELECT LENGTH(gen_random_ulid()::TEXT) AS ulid_length;
+SHOW ulid.node_bits;
+
+-- gen_node_ulid() requires ulid.node_id
+SELECT gen_node_ulid();
+
+-- Generate a sequence of node ULIDs in a single statement
+SET ulid.node_id = 42;
+CREATE TEMPORARY TABLE ulid_node AS
+SELECT n, gen_node_ulid() AS id FROM generate_series(1, 10000) AS n;
+
+-- Verify all ULIDs are unique and carry the node identifier
+SELECT COUNT(DISTINCT id) AS distinct_ids,
+       MIN(ulid_node_id(id)) AS min_node,
+       MAX(ulid_node_id(id, 16)) AS max_node
+FROM ulid_node;
+
+-- Verify generation order matches sort order
+SELECT bool_and(id > prev_id) AS strictly_increasing
+FROM (SELECT id, lag(id) OVER (ORDER BY n) AS prev_id FROM ulid_node) s
+WHERE prev_id IS NOT NULL;
+
+-- Test the widest node identifier
+SET ulid.node_bits = 31;
+SET ulid.node_id = 2147483647;
+SELECT ulid_node_id(gen_node_ulid()) AS node_id;
+
+-- The node identifier must fit in ulid.node_bits
+SET ulid.node_bits = 8;
+SET ulid.node_id = 300;
+SELECT gen_node_ulid();
+
+-- Test extraction from a known ULID
+SELECT ulid_node_id('01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid, 1) AS bits_1,
+       ulid_node_id('01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid, 16) AS bits_16,
+       ulid_node_id('01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid, 31) AS bits_31;
+SELECT ulid_node_id('01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid, 0);
+
+-- Cleanup
+RESET ulid.node_id;
+RESET ulid.node_bits;
+DROP TABLE ulid_node;
@@ -0,0 +1,102 @@
+-- ULID text codec tests
+-- Tests the SIMD text decoder and encoder against the scalar code
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Loading the module defines the codec GUC
+SELECT LENGTH(gen_random_ulid()::TEXT) AS ulid_length;
+SHOW ulid.fast_codec;
+
+-- Parse a string through the text cast, returning the canonical text or the
+-- error message
+CREATE FUNCTION ulid_try_parse(input TEXT) RETURNS TEXT AS $$
+BEGIN
+    RETURN input::ulid::TEXT;
+EXCEPTION WHEN OTHERS THEN
+    RETURN SQLERRM;
+END;
+$$ LANGUAGE plpgsql;
+
+-- The same through the type input function, which reads a NUL-terminated
+-- string instead of a known length
+CREATE FUNCTION ulid_try_parse_cstring(input TEXT) RETURNS TEXT AS $$
+BEGIN
+    RETURN ulid_in(input::cstring)::TEXT;
+EXCEPTION WHEN OTHERS THEN
+    RETURN SQLERRM;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Every printable ASCII character at every position of a valid ULID
+CREATE TEMPORARY TABLE ulid_codec_input AS
+SELECT DISTINCT overlay('01ARZ3NDEKTSV4RRFFQ69G5FAV' PLACING chr(c) FROM pos FOR 1) AS input
+FROM generate_series(1, 26) AS pos, generate_series(33, 126) AS c;
+
+-- Random ULIDs in upper and lower case, and wrong lengths
+INSERT INTO ulid_codec_input
+SELECT gen_random_ulid()::TEXT FROM generate_series(1, 1000);
+INSERT INTO ulid_codec_input
+SELECT lower(gen_random_ulid()::TEXT) FROM generate_series(1, 1000);
+INSERT INTO ulid_codec_input
+VALUES (''), ('01ARZ3NDEKTSV4RRFFQ69G5FA'), ('01ARZ3NDEKTSV4RRFFQ69G5FAVX');
+
+-- Decode every input with and without the SIMD decoder, through both paths
+SET ulid.fast_codec = on;
+CREATE TEMPORARY TABLE ulid_codec_fast AS
+SELECT input, ulid_try_parse(input) AS result,
+       ulid_try_parse_cstring(input) AS result_cstring
+FROM ulid_codec_input;
+SET ulid.fast_codec = off;
+CREATE TEMPORARY TABLE ulid_codec_scalar AS
+SELECT input, ulid_try_parse(input) AS result,
+       ulid_try_parse_cstring(input) AS result_cstring
+FROM ulid_codec_input;
+RESET ulid.fast_codec;
+
+-- Verify both decoders agree on every value and every error, whichever
+-- path they are reached through
+SELECT COUNT(*) AS inputs,
+       COUNT(*) FILTER (WHERE s.result NOT LIKE 'invalid ulid%') AS valid,
+       COUNT(*) FILTER (WHERE f.result IS DISTINCT FROM s.result) AS mismatches,
+       COUNT(*) FILTER (WHERE f.result_cstring IS DISTINCT FROM s.result_cstring) AS cstring_mismatches,
+       COUNT(*) FILTER (WHERE s.result_cstring IS DISTINCT FROM s.result) AS path_mismatches
+FROM ulid_codec_fast f JOIN ulid_codec_scalar s USING (input);
+
+-- Random ULIDs, and every character at every position of the smallest and
+-- largest ULID
+CREATE TEMPORARY TABLE ulid_codec_values (n SERIAL, id ulid);
+INSERT INTO ulid_codec_values (id)
+SELECT gen_random_ulid() FROM generate_series(1, 10000);
+INSERT INTO ulid_codec_values (id)
+SELECT overlay(base PLACING substr('0123456789ABCDEFGHJKMNPQRSTVWXYZ', c, 1) FROM pos FOR 1)::ulid
+FROM (VALUES ('00000000000000000000000000'), ('7ZZZZZZZZZZZZZZZZZZZZZZZZZ')) AS b(base),
+     generate_series(1, 26) AS pos, generate_series(1, 32) AS c
+WHERE pos > 1 OR c <= 8;
+
+-- Encode every value with and without the SIMD encoder
+SET ulid.fast_codec = on;
+CREATE TEMPORARY TABLE ulid_codec_encoded_fast AS
+SELECT n, id, id::TEXT AS encoded FROM ulid_codec_values;
+SET ulid.fast_codec = off;
+CREATE TEMPORARY TABLE ulid_codec_encoded_scalar AS
+SELECT n, id::TEXT AS encoded FROM ulid_codec_values;
+RESET ulid.fast_codec;
+
+-- Verify both encoders produce the same text, and that it decodes back
+SELECT COUNT(*) AS total,
+       COUNT(*) FILTER (WHERE f.encoded <> s.encoded) AS mismatches,
+       COUNT(*) FILTER (WHERE f.encoded::ulid <> f.id) AS round_trip_failures
+FROM ulid_codec_encoded_fast f JOIN ulid_codec_encoded_scalar s USING (n);
+
+-- Cleanup
+DROP TABLE ulid_codec_input;
+DROP TABLE ulid_codec_fast;
+DROP TABLE ulid_codec_scalar;
+DROP TABLE ulid_codec_values;
+DROP TABLE ulid_codec_encoded_fast;
+DROP TABLE ulid_codec_encoded_scalar;
+DROP FUNCTION ulid_try_parse(TEXT);
+DROP FUNCTION ulid_try_parse_cstring(TEXT);
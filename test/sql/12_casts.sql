@@ -0,0 +1,95 @@
+-- ULID cast tests
+-- Tests the conversions between ulid and text / varchar / uuid / bytea
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Conversions to string types and between ulid and uuid are assignment casts,
+-- the others explicit
+SELECT castsource::regtype AS source, casttarget::regtype AS target,
+       castcontext AS context, castfunc::regproc AS function
+FROM pg_cast
+WHERE castsource = 'ulid'::regtype OR casttarget = 'ulid'::regtype
+ORDER BY castsource::regtype::text, casttarget::regtype::text;
+
+-- Test conversion to text and varchar
+SELECT '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid::text AS to_text,
+       '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid::varchar AS to_varchar,
+       '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid::varchar(10) AS to_varchar_10;
+SELECT pg_typeof('01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid::text) AS text_type,
+       pg_typeof('01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid::varchar) AS varchar_type;
+
+-- Test conversion from text and varchar (case-insensitive)
+SELECT '01arz3ndektsv4rrffq69g5fav'::text::ulid AS from_text,
+       '01ARZ3NDEKTSV4RRFFQ69G5FAV'::varchar::ulid AS from_varchar;
+
+-- Test assignment to text and varchar columns
+CREATE TEMPORARY TABLE ulid_cast_target (t TEXT, v VARCHAR(26));
+INSERT INTO ulid_cast_target VALUES ('01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid, '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid);
+SELECT t, v FROM ulid_cast_target;
+
+-- Verify the casts agree with the type's input and output functions
+CREATE TEMPORARY TABLE ulid_cast_round_trip AS
+SELECT gen_random_ulid() AS id FROM generate_series(1, 10000);
+SELECT COUNT(*) FILTER (WHERE id::TEXT <> format('%s', id)) AS text_mismatches,
+       COUNT(*) FILTER (WHERE id::TEXT::ulid <> id) AS round_trip_failures,
+       COUNT(*) FILTER (WHERE lower(id::TEXT)::ulid <> id) AS lowercase_failures
+FROM ulid_cast_round_trip;
+
+-- Same with the scalar codec
+SET ulid.fast_codec = off;
+SELECT COUNT(*) FILTER (WHERE id::TEXT <> format('%s', id)) AS text_mismatches,
+       COUNT(*) FILTER (WHERE id::TEXT::ulid <> id) AS round_trip_failures,
+       COUNT(*) FILTER (WHERE lower(id::TEXT)::ulid <> id) AS lowercase_failures
+FROM ulid_cast_round_trip;
+RESET ulid.fast_codec;
+
+-- Test values stored in a table column
+CREATE TEMPORARY TABLE ulid_cast_source AS
+SELECT id::TEXT AS t, id::VARCHAR AS v FROM ulid_cast_round_trip;
+SELECT COUNT(*) FILTER (WHERE t::ulid::TEXT <> t) AS text_failures,
+       COUNT(*) FILTER (WHERE v::ulid::VARCHAR <> v) AS varchar_failures
+FROM ulid_cast_source;
+
+-- Test conversion to and from uuid and bytea keeps the byte order
+SELECT '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid::uuid AS to_uuid,
+       '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid::bytea AS to_bytea;
+SELECT '01563e3a-b5d3-d676-4c61-efb99302bd5b'::uuid::ulid AS from_uuid,
+       '\x01563e3ab5d3d6764c61efb99302bd5b'::bytea::ulid AS from_bytea;
+SELECT COUNT(*) FILTER (WHERE id::uuid::ulid <> id) AS uuid_failures,
+       COUNT(*) FILTER (WHERE id::bytea <> ulid_send(id)) AS send_mismatches,
+       COUNT(*) FILTER (WHERE id::bytea::ulid <> id) AS bytea_failures
+FROM ulid_cast_round_trip;
+
+-- Verify ulid and uuid values sort the same way
+SELECT COUNT(*) AS order_mismatches
+FROM (SELECT row_number() OVER (ORDER BY id) AS ulid_rank,
+             row_number() OVER (ORDER BY id::uuid) AS uuid_rank
+      FROM ulid_cast_round_trip) s
+WHERE ulid_rank <> uuid_rank;
+
+-- Test migrating a uuid column to ulid and back
+CREATE TEMPORARY TABLE ulid_cast_migrate AS
+SELECT id::uuid AS id FROM ulid_cast_round_trip;
+ALTER TABLE ulid_cast_migrate ALTER COLUMN id TYPE ulid;
+SELECT COUNT(*) AS matched
+FROM ulid_cast_migrate m JOIN ulid_cast_round_trip r ON m.id = r.id;
+ALTER TABLE ulid_cast_migrate ALTER COLUMN id TYPE uuid;
+SELECT COUNT(*) AS matched
+FROM ulid_cast_migrate m JOIN ulid_cast_round_trip r ON m.id = r.id::uuid;
+
+-- Test invalid input
+SELECT '01ARZ3NDEKTSV4RRFFQ69G5FA'::text::ulid;
+SELECT '01ARZ3NDEKTSV4RRFFQ69G5FAVX'::varchar::ulid;
+SELECT ''::text::ulid;
+SELECT '01ARZ3NDEKTSV4RRFFQ69G5FAI'::text::ulid;
+SELECT '81ARZ3NDEKTSV4RRFFQ69G5FAV'::text::ulid;
+SELECT '\x0102'::bytea::ulid;
+
+-- Cleanup
+DROP TABLE ulid_cast_target;
+DROP TABLE ulid_cast_round_trip;
+DROP TABLE ulid_cast_source;
+DROP TABLE ulid_cast_migrate;
@@ -0,0 +1,54 @@
+-- ULID / UUIDv7 conversion tests
+-- Tests ulid_to_uuidv7(), uuidv7_to_ulid() and gen_random_ulid_v7compat()
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Test the example UUIDv7 from RFC 9562 (2022-02-22 19:22:22 UTC)
+SELECT uuidv7_to_ulid('017f22e2-79b0-7cc3-98c4-dc0c0c07398f') AS ulid,
+       LEFT(uuidv7_to_ulid('017f22e2-79b0-7cc3-98c4-dc0c0c07398f')::TEXT, 10) =
+       LEFT(gen_ulid_at('2022-02-22 19:22:22+00')::TEXT, 10) AS same_timestamp;
+SELECT ulid_to_uuidv7(uuidv7_to_ulid('017f22e2-79b0-7cc3-98c4-dc0c0c07398f')) AS uuid;
+
+-- Test a known ULID: the lowest 6 random bits are dropped
+SELECT ulid_to_uuidv7('01ARZ3NDEKTSV4RRFFQ69G5FAV') AS uuid,
+       uuidv7_to_ulid(ulid_to_uuidv7('01ARZ3NDEKTSV4RRFFQ69G5FAV')) AS ulid;
+
+-- Verify version and variant fields and the round trip for many ULIDs
+CREATE TEMPORARY TABLE ulid_v7 AS
+SELECT id, ulid_to_uuidv7(id) AS uuid
+FROM (SELECT gen_random_ulid() AS id FROM generate_series(1, 5000)
+      UNION ALL
+      SELECT id FROM gen_random_ulids(5000) AS id) s;
+SELECT COUNT(*) FILTER (WHERE substr(uuid::TEXT, 15, 1) <> '7') AS bad_versions,
+       COUNT(*) FILTER (WHERE substr(uuid::TEXT, 20, 1) NOT IN ('8', '9', 'a', 'b')) AS bad_variants,
+       COUNT(*) FILTER (WHERE LEFT(replace(uuid::TEXT, '-', ''), 12) <>
+                              LEFT(encode(id::bytea, 'hex'), 12)) AS timestamp_mismatches,
+       COUNT(*) FILTER (WHERE uuidv7_to_ulid(uuid)::bytea <>
+                              set_byte(id::bytea, 15, get_byte(id::bytea, 15) & 192)) AS round_trip_failures,
+       COUNT(*) FILTER (WHERE ulid_to_uuidv7(uuidv7_to_ulid(uuid)) <> uuid) AS uuid_round_trip_failures
+FROM ulid_v7;
+
+-- Verify the conversion preserves sort order, including within a millisecond
+SELECT COUNT(*) AS order_violations
+FROM (SELECT uuid, lag(uuid) OVER (ORDER BY id) AS prev_uuid FROM ulid_v7) s
+WHERE uuid < prev_uuid;
+
+-- Test gen_random_ulid_v7compat(): the bytes are already a UUIDv7
+CREATE TEMPORARY TABLE ulid_v7compat AS
+SELECT gen_random_ulid_v7compat() AS id FROM generate_series(1, 10000);
+SELECT COUNT(DISTINCT id) AS distinct_ids,
+       COUNT(*) FILTER (WHERE substr(id::uuid::TEXT, 15, 1) <> '7') AS bad_versions,
+       COUNT(*) FILTER (WHERE substr(id::uuid::TEXT, 20, 1) NOT IN ('8', '9', 'a', 'b')) AS bad_variants,
+       COUNT(*) FILTER (WHERE ulid_to_uuidv7(uuidv7_to_ulid(id::uuid)) <> id::uuid) AS uuid_round_trip_failures
+FROM ulid_v7compat;
+
+-- Test UUIDs of other versions
+SELECT uuidv7_to_ulid('a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11');
+SELECT uuidv7_to_ulid('017f22e2-79b0-7cc3-c8c4-dc0c0c07398f');
+
+-- Cleanup
+DROP TABLE ulid_v7;
+DROP TABLE ulid_v7compat;
@@ -0,0 +1,51 @@
+-- ULID array conversion tests
+-- Tests ulid_array_out(), ulid_array_to_text() and ulid_array_from_text()
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Test NULL elements, several dimensions and lower bounds other than 1
+SELECT ulid_array_out('{01ARZ3NDEKTSV4RRFFQ69G5FAV,NULL}') AS one_dim;
+SELECT '{{01ARZ3NDEKTSV4RRFFQ69G5FAV,NULL},{NULL,01arz3ndektsv4rrffq69g5fav}}'::ulid[]::text AS two_dims;
+SELECT ulid_array_out('[0:1]={01ARZ3NDEKTSV4RRFFQ69G5FAV,NULL}') AS lower_bound;
+SELECT ulid_array_out('{}') AS empty;
+
+-- Test conversion to and from text[]
+SELECT ulid_array_to_text('[0:1]={01ARZ3NDEKTSV4RRFFQ69G5FAV,NULL}') AS to_text,
+       pg_typeof(ulid_array_to_text('{}')) AS text_type;
+SELECT '{01arz3ndektsv4rrffq69g5fav,NULL}'::text[]::ulid[] AS from_text;
+
+-- Verify every conversion agrees with array_out() and round-trips
+CREATE TEMPORARY TABLE ulid_arrays (n INT, a ulid[]);
+INSERT INTO ulid_arrays VALUES
+    (1, '{}'),
+    (2, ARRAY['01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid]),
+    (3, (SELECT array_agg(CASE WHEN i % 3 = 0 THEN NULL ELSE gen_random_ulid() END ORDER BY i)
+         FROM generate_series(1, 20) AS i)),
+    (4, '{{01ARZ3NDEKTSV4RRFFQ69G5FAV,NULL},{NULL,01ARZ3NDEKTSV4RRFFQ69G5FAV}}'),
+    (5, '[-1:0][1:2][3:3]={{{01ARZ3NDEKTSV4RRFFQ69G5FAV},{NULL}},{{NULL},{7ZZZZZZZZZZZZZZZZZZZZZZZZZ}}}'),
+    (6, gen_random_ulid_array(10000)),
+    (7, ARRAY[NULL]::ulid[]);
+SELECT n, cardinality(a) AS elements,
+       ulid_array_out(a) = format('%s', a) AS out_matches,
+       a::text = format('%s', a) AS cast_matches,
+       format('%s', ulid_array_to_text(a)) = format('%s', a) AS to_text_matches,
+       array_dims(ulid_array_to_text(a)) IS NOT DISTINCT FROM array_dims(a) AS same_dims,
+       ulid_array_from_text(ulid_array_to_text(a)) = a AS round_trip
+FROM ulid_arrays ORDER BY n;
+
+-- Same with the scalar codec
+SET ulid.fast_codec = off;
+SELECT n, ulid_array_out(a) = format('%s', a) AS out_matches,
+       ulid_array_from_text(ulid_array_to_text(a)) = a AS round_trip
+FROM ulid_arrays ORDER BY n;
+RESET ulid.fast_codec;
+
+-- Test invalid elements
+SELECT '{01ARZ3NDEKTSV4RRFFQ69G5FAV,01ARZ}'::text[]::ulid[];
+SELECT ulid_array_from_text('{01ARZ3NDEKTSV4RRFFQ69G5FAV,NULL,01ARZ3NDEKTSV4RRFFQ69G5FAU}');
+
+-- Cleanup
+DROP TABLE ulid_arrays;
@@ -0,0 +1,42 @@
+-- ULID jsonb tests
+-- Tests jsonb_ulid() and the casts between ulid and jsonb
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Test extraction from a document
+SELECT jsonb_ulid('{"id": "01ARZ3NDEKTSV4RRFFQ69G5FAV", "n": 1}', 'id') AS id,
+       jsonb_ulid('{"id": "01arz3ndektsv4rrffq69g5fav"}', 'id') AS lowercase_id;
+
+-- Missing keys, JSON nulls and non-objects give NULL, like ->>
+SELECT jsonb_ulid('{"id": "01ARZ3NDEKTSV4RRFFQ69G5FAV"}', 'other') IS NULL AS missing_key,
+       jsonb_ulid('{"id": null}', 'id') IS NULL AS json_null,
+       jsonb_ulid('["01ARZ3NDEKTSV4RRFFQ69G5FAV"]', 'id') IS NULL AS array_doc,
+       jsonb_ulid('"01ARZ3NDEKTSV4RRFFQ69G5FAV"', 'id') IS NULL AS scalar_doc;
+
+-- Test the casts
+SELECT '"01ARZ3NDEKTSV4RRFFQ69G5FAV"'::jsonb::ulid AS from_jsonb,
+       '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid::jsonb AS to_jsonb,
+       'null'::jsonb::ulid IS NULL AS json_null;
+SELECT jsonb_build_object('id', '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid::jsonb) AS doc;
+
+-- Verify extraction agrees with (doc ->> key)::ulid
+CREATE TEMPORARY TABLE ulid_docs AS
+SELECT jsonb_build_object('id', gen_random_ulid(), 'n', n) AS doc
+FROM generate_series(1, 10000) AS n;
+SELECT COUNT(*) FILTER (WHERE jsonb_ulid(doc, 'id') <> (doc ->> 'id')::ulid) AS extract_mismatches,
+       COUNT(*) FILTER (WHERE (doc -> 'id')::ulid <> (doc ->> 'id')::ulid) AS cast_mismatches,
+       COUNT(*) FILTER (WHERE jsonb_ulid(doc, 'id')::jsonb <> doc -> 'id') AS to_jsonb_mismatches
+FROM ulid_docs;
+
+-- Test values that are not ULID strings
+SELECT jsonb_ulid('{"id": 42}', 'id');
+SELECT jsonb_ulid('{"id": "01ARZ3NDEKTSV4RRFFQ69G5FA"}', 'id');
+SELECT '{"id": "01ARZ3NDEKTSV4RRFFQ69G5FAV"}'::jsonb::ulid;
+SELECT 'true'::jsonb::ulid;
+SELECT '"81ARZ3NDEKTSV4RRFFQ69G5FAV"'::jsonb::ulid;
+
+-- Cleanup
+DROP TABLE ulid_docs;
@@ -0,0 +1,54 @@
+-- ULID time tests
+-- Tests ulid_timestamp(), ulid_min_at() and ulid_max_at()
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Test ulid_timestamp() on a known value
+SELECT to_char(ulid_timestamp('01ARZ3NDEKTSV4RRFFQ69G5FAV') AT TIME ZONE 'UTC',
+               'YYYY-MM-DD HH24:MI:SS.MS') AS ts;
+
+-- Test the smallest and largest timestamps
+SELECT ulid_timestamp('00000000000000000000000000') = '1970-01-01 00:00:00+00' AS is_epoch,
+       to_char(ulid_timestamp('7ZZZZZZZZZZZZZZZZZZZZZZZZZ') AT TIME ZONE 'UTC',
+               'YYYY-MM-DD HH24:MI:SS.MS') AS max_ts;
+
+-- Verify the timestamp of generated ULIDs, truncated to the millisecond
+SELECT ulid_timestamp(gen_ulid_at('2020-01-01 12:34:56.789999+00')) = '2020-01-01 12:34:56.789+00' AS truncated_to_ms,
+       ulid_timestamp(gen_random_ulid())
+           BETWEEN now() - interval '1 minute' AND clock_timestamp() AS is_current;
+
+-- Test ulid_min_at() and ulid_max_at()
+SELECT ulid_min_at('2016-07-30 23:54:10.259+00') AS min_at,
+       ulid_max_at('2016-07-30 23:54:10.259999+00') AS max_at;
+SELECT ulid_min_at('1970-01-01 00:00:00+00') AS epoch_min,
+       ulid_max_at('10889-08-02 05:31:50.655999+00') AS max_max;
+
+-- Verify the bounds enclose every ULID of their millisecond
+SELECT bool_and(id BETWEEN ulid_min_at(ts) AND ulid_max_at(ts)) AS within_bounds,
+       bool_and(ulid_timestamp(ulid_min_at(ts)) = ulid_timestamp(id)) AS same_timestamp
+FROM (SELECT ts, gen_ulid_at(ts) AS id
+      FROM generate_series('2020-01-01 00:00:00+00'::timestamptz,
+                           '2020-01-01 00:00:01+00', interval '1.5 ms') AS ts) s;
+
+-- Verify a range scan on ULID bounds matches filtering on ulid_timestamp()
+CREATE TEMPORARY TABLE ulid_events (id ulid PRIMARY KEY);
+INSERT INTO ulid_events
+SELECT gen_ulid_at('2020-01-01 00:00:00+00'::timestamptz + n * interval '1 second')
+FROM generate_series(0, 9999) AS n;
+SELECT COUNT(*) AS by_bounds
+FROM ulid_events
+WHERE id BETWEEN ulid_min_at('2020-01-01 01:00:00+00') AND ulid_max_at('2020-01-01 01:59:59+00');
+SELECT COUNT(*) AS by_timestamp
+FROM ulid_events
+WHERE ulid_timestamp(id) BETWEEN '2020-01-01 01:00:00+00' AND '2020-01-01 01:59:59+00';
+
+-- Test timestamps that do not fit in a ULID
+SELECT ulid_min_at('1969-12-31 23:59:59.999999+00');
+SELECT ulid_max_at('10889-08-02 05:31:50.656+00');
+SELECT ulid_max_at('infinity');
+
+-- Cleanup
+DROP TABLE ulid_events;
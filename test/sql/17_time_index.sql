@@ -0,0 +1,61 @@
+-- ULID time range index tests
+-- Tests ulid_time_between() and its index support
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+SET TimeZone = 'UTC';
+SET DateStyle = 'ISO';
+
+-- One ULID per second over 10000 seconds
+CREATE TEMPORARY TABLE ulid_events (id ulid PRIMARY KEY, n int4);
+INSERT INTO ulid_events
+SELECT gen_ulid_at('2020-01-01 00:00:00+00'::timestamptz + n * interval '1 second'), n
+FROM generate_series(0, 9999) AS n;
+ANALYZE ulid_events;
+
+-- Verify ulid_time_between() agrees with filtering on ulid_timestamp()
+SELECT COUNT(*) FILTER (WHERE ulid_time_between(id, '2020-01-01 01:00:00+00', '2020-01-01 01:59:59+00')) AS time_between,
+       COUNT(*) FILTER (WHERE ulid_timestamp(id) BETWEEN '2020-01-01 01:00:00+00' AND '2020-01-01 01:59:59+00') AS by_timestamp
+FROM ulid_events;
+
+-- Verify the call becomes a range scan of the primary key
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SET enable_indexonlyscan = off;
+EXPLAIN (COSTS OFF)
+SELECT n FROM ulid_events
+WHERE ulid_time_between(id, '2020-01-01 01:00:00+00', '2020-01-01 01:59:59+00');
+SELECT COUNT(*) AS in_range, MIN(n) AS first_n, MAX(n) AS last_n
+FROM ulid_events
+WHERE ulid_time_between(id, '2020-01-01 01:00:00+00', '2020-01-01 01:59:59+00');
+
+-- Verify the index bounds are rechecked below millisecond precision
+SELECT COUNT(*) AS in_range
+FROM ulid_events
+WHERE ulid_time_between(id, '2020-01-01 01:00:00.0005+00', '2020-01-01 01:00:02+00');
+
+-- Test bounds that are not constants at plan time
+PREPARE ulid_range(timestamptz, timestamptz) AS
+SELECT COUNT(*) FROM ulid_events WHERE ulid_time_between(id, $1, $2);
+SET plan_cache_mode = force_generic_plan;
+EXPLAIN (COSTS OFF)
+EXECUTE ulid_range('2020-01-01 01:00:00+00', '2020-01-01 01:59:59+00');
+EXECUTE ulid_range('2020-01-01 01:00:00+00', '2020-01-01 01:59:59+00');
+
+-- Verify bounds outside the ULID time range are clamped instead of failing
+EXECUTE ulid_range('-infinity', 'infinity');
+EXECUTE ulid_range('1900-01-01 00:00:00+00', '2020-01-01 00:00:09+00');
+SELECT COUNT(*) AS in_range
+FROM ulid_events
+WHERE ulid_time_between(id, '-infinity', '2020-01-01 00:00:09+00');
+
+-- Cleanup
+DEALLOCATE ulid_range;
+RESET plan_cache_mode;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+RESET enable_indexonlyscan;
+DROP TABLE ulid_events;
@@ -0,0 +1,97 @@
+-- ULID vs timestamptz operator tests
+-- Tests the cross-type comparison operators and their btree support
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+SET TimeZone = 'UTC';
+SET DateStyle = 'ISO';
+
+-- Test comparisons around the millisecond of 01ARZ3NDEKTSV4RRFFQ69G5FAV
+-- (2016-07-30 23:54:10.259+00): a ULID sorts just after its millisecond starts
+SELECT ts,
+       id < ts AS lt, id <= ts AS le, id > ts AS gt, id >= ts AS ge,
+       ts < id AS ts_lt, ts <= id AS ts_le, ts > id AS ts_gt, ts >= id AS ts_ge
+FROM (VALUES ('2016-07-30 23:54:10.258999+00'::timestamptz),
+             ('2016-07-30 23:54:10.259+00'),
+             ('2016-07-30 23:54:10.259001+00'),
+             ('2016-07-30 23:54:10.26+00')) AS v(ts),
+     (SELECT '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid AS id) u
+ORDER BY ts;
+SELECT '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid < 'infinity'::timestamptz AS before_infinity,
+       '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid > '-infinity'::timestamptz AS after_minus_infinity,
+       '01ARZ3NDEKTSV4RRFFQ69G5FAV'::ulid > '2016-07-30'::date AS after_date;
+
+-- Verify the operators agree with ulid_timestamp() at sub-millisecond bounds
+SELECT COUNT(*) FILTER (WHERE (id < ts) <> (ulid_timestamp(id) < ts)
+                           OR (id <= ts) <> (ulid_timestamp(id) < ts)
+                           OR (id > ts) <> (ulid_timestamp(id) >= ts)
+                           OR (id >= ts) <> (ulid_timestamp(id) >= ts)
+                           OR (ts > id) <> (id < ts)
+                           OR (ts <= id) <> (id >= ts)) AS mismatches
+FROM (SELECT gen_ulid_at('2020-01-01 00:00:00+00'::timestamptz + n * interval '1 ms') AS id
+      FROM generate_series(0, 999) AS n) i,
+     (SELECT '2020-01-01 00:00:00+00'::timestamptz + n * interval '250 us' AS ts
+      FROM generate_series(0, 400) AS n) t;
+
+-- One ULID per second over 10000 seconds
+CREATE TEMPORARY TABLE ulid_events (id ulid PRIMARY KEY, n int4);
+INSERT INTO ulid_events
+SELECT gen_ulid_at('2020-01-01 00:00:00+00'::timestamptz + n * interval '1 second'), n
+FROM generate_series(0, 9999) AS n;
+ANALYZE ulid_events;
+
+-- Verify time bounds drive a range scan of the primary key
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SET enable_indexonlyscan = off;
+EXPLAIN (COSTS OFF)
+SELECT n FROM ulid_events
+WHERE id >= '2020-01-01 01:00:00+00'::timestamptz AND id < '2020-01-01 02:00:00+00'::timestamptz;
+SELECT COUNT(*) AS in_range, MIN(n) AS first_n, MAX(n) AS last_n
+FROM ulid_events
+WHERE id >= '2020-01-01 01:00:00+00'::timestamptz AND id < '2020-01-01 02:00:00+00'::timestamptz;
+
+-- Verify a timestamp on the left and a stable expression also use the index
+EXPLAIN (COSTS OFF)
+SELECT n FROM ulid_events WHERE now() - interval '1 hour' <= id;
+
+-- BETWEEN selects the half-open range [start, end)
+SELECT COUNT(*) AS in_range
+FROM ulid_events
+WHERE id BETWEEN '2020-01-01 01:00:00+00'::timestamptz AND '2020-01-01 02:00:00+00'::timestamptz;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+RESET enable_indexonlyscan;
+
+-- Test partition pruning on a ulid range partition key
+CREATE FUNCTION ulid_scanned_partitions(query TEXT) RETURNS SETOF TEXT AS $$
+DECLARE
+    line TEXT;
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (COSTS OFF) ' || query LOOP
+        IF line ~ 'Scan on ' THEN
+            RETURN NEXT substring(line FROM 'Scan on (\w+)');
+        END IF;
+    END LOOP;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TABLE ulid_parts (id ulid) PARTITION BY RANGE (id);
+CREATE TABLE ulid_parts_2020 PARTITION OF ulid_parts
+    FOR VALUES FROM (ulid_min_at('2020-01-01 00:00:00+00')) TO (ulid_min_at('2021-01-01 00:00:00+00'));
+CREATE TABLE ulid_parts_2021 PARTITION OF ulid_parts
+    FOR VALUES FROM (ulid_min_at('2021-01-01 00:00:00+00')) TO (ulid_min_at('2022-01-01 00:00:00+00'));
+CREATE TABLE ulid_parts_2022 PARTITION OF ulid_parts
+    FOR VALUES FROM (ulid_min_at('2022-01-01 00:00:00+00')) TO (ulid_min_at('2023-01-01 00:00:00+00'));
+
+SELECT ulid_scanned_partitions('SELECT * FROM ulid_parts WHERE id >= ''2021-06-01 00:00:00+00''::timestamptz') AS scanned;
+SELECT ulid_scanned_partitions('SELECT * FROM ulid_parts WHERE id < ''2021-01-01 00:00:00+00''::timestamptz') AS scanned;
+SELECT ulid_scanned_partitions('SELECT * FROM ulid_parts WHERE id >= ''2021-03-01 00:00:00+00''::timestamptz AND id < ''2021-04-01 00:00:00+00''::timestamptz') AS scanned;
+
+-- Cleanup
+DROP TABLE ulid_events;
+DROP TABLE ulid_parts;
+DROP FUNCTION ulid_scanned_partitions(TEXT);
@@ -0,0 +1,72 @@
+-- Selectivity estimation tests
+-- Tests that range conditions on ulid columns are estimated from statistics
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+SET TimeZone = 'UTC';
+SET DateStyle = 'ISO';
+
+-- Planner row estimate of a query
+CREATE FUNCTION ulid_row_estimate(query TEXT) RETURNS FLOAT8 AS $$
+DECLARE
+    plan JSON;
+BEGIN
+    EXECUTE 'EXPLAIN (FORMAT JSON) ' || query INTO plan;
+    RETURN (plan -> 0 -> 'Plan' ->> 'Plan Rows')::FLOAT8;
+END;
+$$ LANGUAGE plpgsql;
+
+-- One ULID per second over the 10000 seconds up to now, so that the
+-- statistics are current: the estimators take the rows inserted since ANALYZE
+-- to run from the newest ULID analyzed up to the current time
+SELECT date_trunc('second', now()) - interval '10000 seconds' AS base \gset
+CREATE TEMPORARY TABLE ulid_events (id ulid, n int4);
+INSERT INTO ulid_events
+SELECT gen_ulid_at(:'base'::timestamptz + n * interval '1 second'), n
+FROM generate_series(0, 9999) AS n;
+ANALYZE ulid_events;
+
+-- Test ULID bounds (2800 and 600 rows)
+SELECT ulid_row_estimate(format('SELECT * FROM ulid_events WHERE id >= ulid_min_at(%L)',
+                                :'base'::timestamptz + interval '7200 seconds'))
+       BETWEEN 2520 AND 3080 AS ge_ulid;
+SELECT ulid_row_estimate(format('SELECT * FROM ulid_events WHERE id < ulid_min_at(%L)',
+                                :'base'::timestamptz + interval '600 seconds'))
+       BETWEEN 540 AND 660 AS lt_ulid;
+
+-- Test timestamptz bounds on either side (600, 400 and 2800 rows)
+SELECT ulid_row_estimate(format('SELECT * FROM ulid_events WHERE id < %L::timestamptz',
+                                :'base'::timestamptz + interval '600 seconds'))
+       BETWEEN 540 AND 660 AS lt_timestamptz;
+SELECT ulid_row_estimate(format('SELECT * FROM ulid_events WHERE id >= %L::timestamptz',
+                                :'base'::timestamptz + interval '9600 seconds'))
+       BETWEEN 360 AND 440 AS ge_timestamptz;
+SELECT ulid_row_estimate(format('SELECT * FROM ulid_events WHERE %L::timestamptz <= id',
+                                :'base'::timestamptz + interval '7200 seconds'))
+       BETWEEN 2520 AND 3080 AS timestamptz_le;
+
+-- Test that estimates never grow as the bound moves later, across the newest
+-- ULID analyzed (at 9999 seconds) and on past the current time
+SELECT bool_and(rows <= prev_rows) AS non_increasing
+FROM (SELECT rows, lag(rows) OVER (ORDER BY seconds) AS prev_rows
+      FROM (SELECT seconds,
+                   ulid_row_estimate(format('SELECT * FROM ulid_events WHERE id >= %L::timestamptz',
+                                            :'base'::timestamptz + seconds * interval '1 second')) AS rows
+            FROM unnest(ARRAY[9900, 9939, 9998, 9999, 10000, 10001, 10060, 20000]) AS seconds) e) s;
+
+-- Test ulid_time_between() as one range (60 rows)
+SELECT ulid_row_estimate(format('SELECT * FROM ulid_events WHERE ulid_time_between(id, %L, %L)',
+                                :'base'::timestamptz + interval '3600 seconds',
+                                :'base'::timestamptz + interval '3659.999 seconds'))
+       BETWEEN 54 AND 66 AS time_between;
+
+-- Test a join on ulid (10000 rows)
+SELECT ulid_row_estimate('SELECT * FROM ulid_events a JOIN ulid_events b ON a.id = b.id')
+       BETWEEN 9000 AND 11000 AS eq_join;
+
+-- Cleanup
+DROP TABLE ulid_events;
+DROP FUNCTION ulid_row_estimate(TEXT);
@@ -0,0 +1,85 @@
+-- Type analyze tests
+-- Tests the timestamp statistics ANALYZE collects for ulid columns
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+SET TimeZone = 'UTC';
+SET DateStyle = 'ISO';
+
+SELECT typanalyze FROM pg_type WHERE typname = 'ulid';
+
+-- Planner row estimate of a query
+CREATE FUNCTION ulid_row_estimate(query TEXT) RETURNS FLOAT8 AS $$
+DECLARE
+    plan JSON;
+BEGIN
+    EXECUTE 'EXPLAIN (FORMAT JSON) ' || query INTO plan;
+    RETURN (plan -> 0 -> 'Plan' ->> 'Plan Rows')::FLOAT8;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Three days, each twice as busy as the one before: one ULID a minute,
+-- every 30 seconds, then every 15 seconds, with some NULLs
+CREATE TEMPORARY TABLE ulid_events (id ulid);
+INSERT INTO ulid_events
+SELECT gen_ulid_at('2020-01-01 00:00:00+00'::timestamptz + n * interval '1 minute')
+FROM generate_series(0, 1439) AS n;
+INSERT INTO ulid_events
+SELECT gen_ulid_at('2020-01-02 00:00:00+00'::timestamptz + n * interval '30 seconds')
+FROM generate_series(0, 2879) AS n;
+INSERT INTO ulid_events
+SELECT gen_ulid_at('2020-01-03 00:00:00+00'::timestamptz + n * interval '15 seconds')
+FROM generate_series(0, 5759) AS n;
+INSERT INTO ulid_events SELECT NULL FROM generate_series(1, 100);
+ANALYZE ulid_events;
+
+-- Test the time histogram: oldest and newest timestamps at the ends
+SELECT array_length(h.bounds, 1) AS bounds, h.bounds[1] AS oldest,
+       h.bounds[array_length(h.bounds, 1)] AS newest
+FROM (SELECT s.vals::timestamptz[] AS bounds
+      FROM pg_statistic,
+           LATERAL (VALUES (stakind1, stavalues1::text), (stakind2, stavalues2::text),
+                           (stakind3, stavalues3::text), (stakind4, stavalues4::text),
+                           (stakind5, stavalues5::text)) AS s(kind, vals)
+      WHERE starelid = 'ulid_events'::regclass AND staattnum = 1 AND s.kind = 10701) h;
+
+-- Test the day density sketch: the share of non-null rows in each day
+SELECT s.vals AS days, (SELECT array_agg(round(d::numeric, 4)) FROM unnest(s.nums) AS d) AS density
+FROM pg_statistic,
+     LATERAL (VALUES (stakind1, stavalues1::text, stanumbers1),
+                     (stakind2, stavalues2::text, stanumbers2),
+                     (stakind3, stavalues3::text, stanumbers3),
+                     (stakind4, stavalues4::text, stanumbers4),
+                     (stakind5, stavalues5::text, stanumbers5)) AS s(kind, vals, nums)
+WHERE starelid = 'ulid_events'::regclass AND staattnum = 1 AND s.kind = 10702;
+
+-- Test the last five minutes sampled (20 rows), the busiest day (5760) and
+-- the quietest (1440).  The statistics are years old, so a tenth of the table
+-- (autovacuum_analyze_scale_factor, 1008 rows) is taken to have been inserted
+-- since ANALYZE, after the newest sampled row, and the sampled rows to make
+-- up the other nine tenths.
+SELECT ulid_row_estimate('SELECT * FROM ulid_events WHERE id >= ''2020-01-03 23:55:00+00''::timestamptz')
+       BETWEEN 1024 AND 1028 AS last_minutes;
+SELECT ulid_row_estimate('SELECT * FROM ulid_events WHERE id >= ''2020-01-03 00:00:00+00''::timestamptz')
+       BETWEEN 5674 AND 6710 AS last_day;
+SELECT ulid_row_estimate('SELECT * FROM ulid_events WHERE id < ulid_min_at(''2020-01-02 00:00:00+00'')')
+       BETWEEN 1166 AND 1426 AS first_day;
+
+-- Test bounds around the newest sampled row (23:59:45): just after it is not
+-- estimated above just before it, and the assumed new rows stay capped
+SELECT ulid_row_estimate('SELECT * FROM ulid_events WHERE id >= ''2020-01-03 23:59:44+00''::timestamptz')
+       >= ulid_row_estimate('SELECT * FROM ulid_events WHERE id >= ''2020-01-03 23:59:46+00''::timestamptz')
+       AS non_increasing,
+       ulid_row_estimate('SELECT * FROM ulid_events WHERE id >= ''2020-01-04 00:00:00+00''::timestamptz')
+       BETWEEN 1000 AND 1010 AS capped_tail;
+
+-- Test that the standard statistics are still collected
+SELECT round(null_frac::numeric, 4) AS null_frac, histogram_bounds IS NOT NULL AS has_histogram, correlation IS NOT NULL AS has_correlation
+FROM pg_stats WHERE tablename = 'ulid_events' AND attname = 'id';
+
+-- Cleanup
+DROP TABLE ulid_events;
+DROP FUNCTION ulid_row_estimate(TEXT);
@@ -0,0 +1,80 @@
+-- Upgrade tests
+-- Tests that updating from 0.1.0 gives the same catalog entries as a fresh install
+
+SET client_min_messages = error;
+\set ECHO none
+CREATE EXTENSION pg_ulid;
+\set ECHO all
+
+-- Catalog entries of the installed extension that the planner and executor
+-- use.  ALTER TYPE can only set the analyze function from PostgreSQL 13, so
+-- typanalyze is compared from there on.
+CREATE FUNCTION ulid_catalog() RETURNS TABLE (kind TEXT, entry TEXT) AS $$
+    WITH members AS (
+        SELECT d.classid, d.objid
+        FROM pg_depend d JOIN pg_extension e ON e.oid = d.refobjid
+        WHERE d.refclassid = 'pg_extension'::regclass AND d.deptype = 'e'
+          AND e.extname = 'pg_ulid')
+    SELECT 'function', format('%s %s %s %s %s %s', p.oid::regprocedure, p.provolatile,
+                              p.proparallel, p.proisstrict, p.prosrc, p.prosupport)
+    FROM pg_proc p JOIN members m ON m.classid = 'pg_proc'::regclass AND m.objid = p.oid
+    UNION ALL
+    SELECT 'operator', format('%s %s %s %s %s %s', o.oid::regoperator, o.oprcode,
+                              o.oprcom::regoperator, o.oprnegate::regoperator,
+                              o.oprrest, o.oprjoin)
+    FROM pg_operator o JOIN members m ON m.classid = 'pg_operator'::regclass AND m.objid = o.oid
+    UNION ALL
+    SELECT 'amop', format('%s %s %s %s', am.amname, a.amopstrategy,
+                          a.amopopr::regoperator, a.amoppurpose)
+    FROM pg_amop a
+         JOIN pg_opfamily f ON f.oid = a.amopfamily
+         JOIN pg_am am ON am.oid = f.opfmethod
+         JOIN members m ON m.classid = 'pg_opfamily'::regclass AND m.objid = f.oid
+    UNION ALL
+    SELECT 'amproc', format('%s %s %s %s %s', am.amname, a.amproclefttype::regtype,
+                            a.amprocrighttype::regtype, a.amprocnum, a.amproc::regprocedure)
+    FROM pg_amproc a
+         JOIN pg_opfamily f ON f.oid = a.amprocfamily
+         JOIN pg_am am ON am.oid = f.opfmethod
+         JOIN members m ON m.classid = 'pg_opfamily'::regclass AND m.objid = f.oid
+    UNION ALL
+    SELECT 'cast', format('%s %s %s %s', c.castsource::regtype, c.casttarget::regtype,
+                          c.castfunc::regprocedure, c.castcontext)
+    FROM pg_cast c JOIN members m ON m.classid = 'pg_cast'::regclass AND m.objid = c.oid
+    UNION ALL
+    SELECT 'typanalyze', format('%s %s', t.typname, t.typanalyze)
+    FROM pg_type t JOIN members m ON m.classid = 'pg_type'::regclass AND m.objid = t.oid
+    WHERE current_setting('server_version_num')::int >= 130000
+$$ LANGUAGE sql;
+
+-- Update a 0.1.0 install to the current version
+DROP EXTENSION pg_ulid CASCADE;
+CREATE EXTENSION pg_ulid VERSION '0.1.0';
+ALTER EXTENSION pg_ulid UPDATE;
+SELECT extversion FROM pg_extension WHERE extname = 'pg_ulid';
+CREATE TEMPORARY TABLE ulid_upgraded AS SELECT * FROM ulid_catalog();
+
+-- Install the current version directly
+DROP EXTENSION pg_ulid;
+CREATE EXTENSION pg_ulid;
+CREATE TEMPORARY TABLE ulid_installed AS SELECT * FROM ulid_catalog();
+
+-- Test that both have every entry
+SELECT count(*) FILTER (WHERE kind = 'function') AS functions,
+       count(*) FILTER (WHERE kind = 'operator') AS operators,
+       count(*) FILTER (WHERE kind = 'amop') AS amops,
+       count(*) FILTER (WHERE kind = 'amproc') AS amprocs,
+       count(*) FILTER (WHERE kind = 'cast') AS casts
+FROM ulid_installed;
+
+-- Test that the entries are the same: volatility and parallel labels,
+-- estimators, operator families and the analyze function
+SELECT 'only installed' AS diff, * FROM (TABLE ulid_installed EXCEPT ALL TABLE ulid_upgraded) i
+UNION ALL
+SELECT 'only upgraded', * FROM (TABLE ulid_upgraded EXCEPT ALL TABLE ulid_installed) u
+ORDER BY 2, 3;
+
+-- Cleanup
+DROP TABLE ulid_installed;
+DROP TABLE ulid_upgraded;
+DROP FUNCTION ulid_catalog();